@@ -4,10 +4,15 @@
 #include "glo/glohud.hpp"			// Head-up-display
 #include "glo/glofb.hpp"			// Framebuffer
 #include "glo/glop.hpp"				// Platform (win/nix)
+#include "glo/glopf.hpp"			// Pixel formats (conversion)
+#include "glo/gloprof.hpp"			// GPU profiler
 #include "glo/gloq.hpp"				// Quad
 #include "glo/glos.hpp"				// Shader
 #include "glo/glot.hpp"				// Texture
+#include "glo/glota.hpp"			// Texture atlas
+#include "glo/glotc.hpp"			// Compressed texture (DDS, KTX2)
 #include "glo/glotf.hpp"			// Typeface (text, bitmap font, ttf font)
+#include "glo/glou.hpp"				// Upload (worker contexts)
 #include "glo/glow.hpp"				// Window
 
 #endif // GLO_HPP
@@ -2,6 +2,9 @@
 #define GLOFB_HPP
 
 #include "glop.hpp"
+#include "glopf.hpp"
+#include "gloprof.hpp"
+#include "glot.hpp"
 
 #include <stdexcept>
 #include <vector>
@@ -10,8 +13,8 @@ namespace glo
 {
     class frame_buffer
     {
-        GLFN(GLBINDFRAMEBUFFER, glBindFramebuffer)
-        GLFN(GLFRAMEBUFFERTEXTURE, glFramebufferTexture)
+        // entry points of the context this frame buffer was created in...
+        const gl* gl_ = &gl::current();
 
     public:
 
@@ -27,8 +30,7 @@ namespace glo
         frame_buffer(int width, int height, float scale = 1.0f)
             : width_(width), height_(height), scale_(scale)
         {
-            GLFN(GLGENFRAMEBUFFERS, glGenFramebuffers)
-            glGenFramebuffers(1, &fbo_);
+            gl_->glGenFramebuffers(1, &fbo_);
         }
 
         void resize(int w, int h)
@@ -55,30 +57,30 @@ namespace glo
             depth_.type_ = GL_FLOAT;
             depth_.attachment_ = GL_DEPTH_ATTACHMENT;
 
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
-            glGenTextures(GL_TEXTURE_2D, &depth_.texture_);
+            gl_->glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+            glGenTextures(1, &depth_.texture_);
+            glBindTexture(GL_TEXTURE_2D, depth_.texture_);
             glTexImage2D(GL_TEXTURE_2D, 0, depth_.internal_format_, static_cast<GLsizei>(width_ * scale_), static_cast<GLsizei>(height_ * scale_), 0, depth_.format_, depth_.type_, 0);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glFramebufferTexture(GL_FRAMEBUFFER, depth_.attachment_, depth_.texture_, 0);
+            gl_->glFramebufferTexture(GL_FRAMEBUFFER, depth_.attachment_, depth_.texture_, 0);
+            glBindTexture(GL_TEXTURE_2D, NULL);
+            gl_->glBindFramebuffer(GL_FRAMEBUFFER, NULL);
         }
 
         // Add a target
         void color_attachment(GLint internal_format, GLenum format, GLenum type, GLenum filter, GLenum wrapping)
         {
-            GLFN(GLDRAWBUFFERS, glDrawBuffers)
-                GLFN(GLCHECKFRAMEBUFFERSTATUS, glCheckFramebufferStatus)
-
-                // add a target...
-                attachment t;
+            // add a target...
+            attachment t;
             t.internal_format_ = internal_format;
             t.format_ = format;
             t.type_ = type;
             t.attachment_ = GL_COLOR_ATTACHMENT0 + static_cast<GLint>(attachments_.size());
 
-            glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+            gl_->glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
             glGenTextures(1, &t.texture_);
             glBindTexture(GL_TEXTURE_2D, t.texture_);
             glTexImage2D(GL_TEXTURE_2D, 0, t.internal_format_, static_cast<GLsizei>(width_ * scale_), static_cast<GLsizei>(height_ * scale_), 0, t.format_, t.type_, 0);
@@ -86,18 +88,18 @@ namespace glo
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapping);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapping);
-            glFramebufferTexture(GL_FRAMEBUFFER, t.attachment_, t.texture_, 0);
+            gl_->glFramebufferTexture(GL_FRAMEBUFFER, t.attachment_, t.texture_, 0);
 
             attachments_.emplace_back(t);
             std::vector<GLenum> draw_buffers;
             for (auto a = attachments_.begin(); a != attachments_.end(); ++a)
                 draw_buffers.emplace_back(a->attachment_);
 
-            glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), &draw_buffers.front());
-            GLuint fb_status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            gl_->glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), &draw_buffers.front());
+            GLuint fb_status = gl_->glCheckFramebufferStatus(GL_FRAMEBUFFER);
             if (fb_status != GL_FRAMEBUFFER_COMPLETE)
                 throw std::runtime_error("Framebuffer incomplete.");
-            glBindFramebuffer(GL_FRAMEBUFFER, NULL);
+            gl_->glBindFramebuffer(GL_FRAMEBUFFER, NULL);
         }
 
         const std::vector<attachment>& color_attachment() const { return attachments_; }
@@ -119,19 +121,15 @@ namespace glo
         std::vector<attachment> attachments_;
     };
 
-#ifdef GLOT_HPP
     static image frame_buffer_read(int width, int height)
     {
-        image result;
-        result.width_ = static_cast<GLsizei>(width);
-        result.height_ = static_cast<GLsizei>(height);
-        result.channels_ = 4;
-        result.data_ = std::vector<unsigned char>(result.width_ * result.height_ * result.channels_);
+        image result(width, height, 4, std::vector<unsigned char>(static_cast<std::size_t>(width) * height * 4));
 
-        GLFN(GLBINDFRAMEBUFFER, glBindFramebuffer)
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, NULL);
-        glReadPixels(0, 0, result.width_, result.height_, GL_RGBA, GL_UNSIGNED_BYTE, &result.data_.front());
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, NULL);
+        gpu_scope scope("frame_buffer_read");
+        const gl& gl_fn = gl::current();
+        gl_fn.glBindFramebuffer(GL_READ_FRAMEBUFFER, NULL);
+        glReadPixels(0, 0, result.width_, result.height_, GL_RGBA, GL_UNSIGNED_BYTE, result.pixels());
+        gl_fn.glBindFramebuffer(GL_READ_FRAMEBUFFER, NULL);
         return result;
     }
 
@@ -142,8 +140,9 @@ namespace glo
         result.height_ = static_cast<GLsizei>(fb.height());
         result.channels_ = 4;
 
-        GLFN(GLBINDFRAMEBUFFER, glBindFramebuffer)
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fbo());
+        gpu_scope scope("framebuffer_read");
+        const gl& gl_fn = gl::current();
+        gl_fn.glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fbo());
         if (colour_attachment == GL_DEPTH_ATTACHMENT)
         {
             throw std::runtime_error("read depth buffer nyi.");
@@ -157,22 +156,20 @@ namespace glo
                 glReadBuffer(target.attachment_);
                 glReadPixels(0, 0, result.width_, result.height_, target.format_, target.type_, &buffer.front());
 
-                // convert to rgba32...
-                result.data_ = std::vector<unsigned char>(result.width_ * result.height_ * result.channels_);
-                for (unsigned int b = 0; b < buffer.size(); ++b)
-                    result.data_[b] = static_cast<unsigned char>(buffer[b] * 255.0f);
+                // convert to rgba32, clamped (HDR values would otherwise wrap)...
+                image_view floats(result.width_, result.height_, 16, reinterpret_cast<const unsigned char*>(&buffer.front()));
+                result = image_convert(floats, pixel_format::rgba32f, pixel_format::rgba8);
             }
             if (target.type_ == GL_UNSIGNED_BYTE)
             {
-                result.data_ = std::vector<unsigned char>(result.width_ * result.height_ * result.channels_);
+                result = image(result.width_, result.height_, result.channels_, std::vector<unsigned char>(static_cast<std::size_t>(result.width_) * result.height_ * result.channels_));
                 glReadBuffer(target.attachment_);
-                glReadPixels(0, 0, result.width_, result.height_, target.format_, target.type_, &result.data_.front());
+                glReadPixels(0, 0, result.width_, result.height_, target.format_, target.type_, result.pixels());
             }
         }
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, NULL);
+        gl_fn.glBindFramebuffer(GL_READ_FRAMEBUFFER, NULL);
         return result;
     }
-#endif
 
 }   // namespace glo
 
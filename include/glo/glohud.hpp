@@ -2,6 +2,7 @@
 #define GLOHUD_HPP
 
 #include "glofb.hpp"
+#include "gloprof.hpp"
 #include "gloq.hpp"
 #include "glot.hpp"
 #include "glotf.hpp"
@@ -16,7 +17,13 @@ namespace glo
         bitmap_font type_face_;
         quad quad_;
 
-        unsigned int program_;
+        // entry points of the context this hud was created in...
+        const gl* gl_ = &gl::current();
+
+        // created on the first draw, colours set before then are applied to it...
+        unsigned int program_ = 0;
+        float fg_colour_[4] = { 0.8f, 0.8f, 0.8f, 1.0f };
+        float bg_colour_[4] = { 0.0f, 0.0f, 0.0f, 0.5f };
 
         // Uniforms
         int frag_bitmap_font_location_ = -1;
@@ -66,9 +73,8 @@ namespace glo
 
         void start_render()
         {
-            GLFN(GLUNIFORM1I, glUniform1i)
-            GLFN(GLUSEPROGRAM, glUseProgram)
-            GLFN(GLACTIVETEXTURE, glActiveTexture)
+            if (!program_)
+                create_program();
 
             glViewport(0, 0, viewport_width_, viewport_height_);
             glClearColor(0, 0, 0, 0);
@@ -76,46 +82,17 @@ namespace glo
             glEnable(GL_BLEND);
             glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-            glUseProgram(program_);
-            glActiveTexture(GL_TEXTURE0);
+            gl_->glUseProgram(program_);
+            gl_->glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, type_face_.ID());
-            glUniform1i(frag_bitmap_font_location_, 0);
+            gl_->glUniform1i(frag_bitmap_font_location_, 0);
 
             is_drawing_ = true;     // nothing will be buffered...
         }
 
-        void end_render()
-        {
-            glDisable(GL_BLEND);
-
-            is_drawing_ = false;
-        }
-    protected:
-
-        // render operations....
-        void paint_glyph(const glo::glyph& g, int x, int y)
-        {
-            GLFN(GLUNIFORM2F, glUniform2f)
-            glUniform2f(vert_xy_location_, static_cast<float>(x) * x_step_, static_cast<float>(y) * y_step_);
-            glUniform2f(vert_wh_location_, static_cast<float>(char_width_) * x_step_, static_cast<float>(char_height_) * y_step_);
-            glUniform2f(vert_stxy_location_, static_cast<float>(g.x_) * s_step_, static_cast<float>(g.y_) * t_step_);
-            glUniform2f(vert_stwh_location_, static_cast<float>(g.width_) * s_step_, static_cast<float>(g.height_) * t_step_);
-            quad_.draw_frame();
-        }
-
-        struct render_wrapper
+        // create our hud shader program...
+        void create_program()
         {
-            hud* handle_;
-        public:
-            render_wrapper(hud* handle) : handle_(handle) { handle_->start_render(); }
-            ~render_wrapper() { handle_->end_render(); }
-        };
-
-    public:
-        hud(int viewport_width, int viewport_height, const bitmap_font& type_face)
-            : type_face_(type_face), viewport_width_(viewport_width), viewport_height_(viewport_height)
-        {
-            // create our hud shader program...
             program_ = glo::glsl_link({ 
                 glo::glsl_compile(GL_VERTEX_SHADER, R"(
 			        #version 410 core
@@ -163,19 +140,63 @@ namespace glo
                 });
 
             // Setup our program...
-            GLFN(GLUSEPROGRAM, glUseProgram)
-            GLFN(GLGETUNIFORMLOCATION, glGetUniformLocation)
-            glUseProgram(program_);
-            vert_xy_location_ = glGetUniformLocation(program_, "xy");
-            vert_wh_location_ = glGetUniformLocation(program_, "wh");
-            vert_stxy_location_ = glGetUniformLocation(program_, "stxy");
-            vert_stwh_location_ = glGetUniformLocation(program_, "stwh");
-            frag_bitmap_font_location_ = glGetUniformLocation(program_, "fontmap");
-            frag_fgcolour_location_ = glGetUniformLocation(program_, "fgColour");
-            frag_bgcolour_location_ = glGetUniformLocation(program_, "bgColour");
-            
-            // Set the default colour and char dim...
-            colour(0.8f, 0.8f, 0.8f, 1.0f, 0, 0, 0, 0.5f);
+            gl_->glUseProgram(program_);
+            vert_xy_location_ = gl_->glGetUniformLocation(program_, "xy");
+            vert_wh_location_ = gl_->glGetUniformLocation(program_, "wh");
+            vert_stxy_location_ = gl_->glGetUniformLocation(program_, "stxy");
+            vert_stwh_location_ = gl_->glGetUniformLocation(program_, "stwh");
+            frag_bitmap_font_location_ = gl_->glGetUniformLocation(program_, "fontmap");
+            frag_fgcolour_location_ = gl_->glGetUniformLocation(program_, "fgColour");
+            frag_bgcolour_location_ = gl_->glGetUniformLocation(program_, "bgColour");
+
+            gl_->glUniform4f(frag_fgcolour_location_, fg_colour_[0], fg_colour_[1], fg_colour_[2], fg_colour_[3]);
+            gl_->glUniform4f(frag_bgcolour_location_, bg_colour_[0], bg_colour_[1], bg_colour_[2], bg_colour_[3]);
+        }
+
+        void set_colour(float* colour, int location, float r, float g, float b, float a)
+        {
+            colour[0] = r;
+            colour[1] = g;
+            colour[2] = b;
+            colour[3] = a;
+            if (program_)
+            {
+                gl_->glUseProgram(program_);
+                gl_->glUniform4f(location, r, g, b, a);
+            }
+        }
+
+        void end_render()
+        {
+            glDisable(GL_BLEND);
+
+            is_drawing_ = false;
+        }
+    protected:
+
+        // render operations....
+        void paint_glyph(const glo::glyph& g, int x, int y)
+        {
+            gl_->glUniform2f(vert_xy_location_, static_cast<float>(x) * x_step_, static_cast<float>(y) * y_step_);
+            gl_->glUniform2f(vert_wh_location_, static_cast<float>(char_width_) * x_step_, static_cast<float>(char_height_) * y_step_);
+            gl_->glUniform2f(vert_stxy_location_, static_cast<float>(g.x_) * s_step_, static_cast<float>(g.y_) * t_step_);
+            gl_->glUniform2f(vert_stwh_location_, static_cast<float>(g.width_) * s_step_, static_cast<float>(g.height_) * t_step_);
+            quad_.draw_frame();
+        }
+
+        struct render_wrapper
+        {
+            hud* handle_;
+        public:
+            render_wrapper(hud* handle) : handle_(handle) { handle_->start_render(); }
+            ~render_wrapper() { handle_->end_render(); }
+        };
+
+    public:
+        hud(int viewport_width, int viewport_height, const bitmap_font& type_face)
+            : type_face_(type_face), viewport_width_(viewport_width), viewport_height_(viewport_height)
+        {
+            // Set the default char dim...
             char_width_ = 11;
             char_height_ = 24;
             resize(viewport_width, viewport_height);
@@ -190,34 +211,22 @@ namespace glo
         }
         std::string colour(float r, float g, float b, float a = 1.0f)
         {
-            GLFN(GLUSEPROGRAM, glUseProgram)
-            GLFN(GLUNIFORM4F, glUniform4f)
-            glUseProgram(program_);
-            glUniform4f(frag_fgcolour_location_, r, g, b, a);
+            set_colour(fg_colour_, frag_fgcolour_location_, r, g, b, a);
             return std::string();
         }
         std::string colour(float r, float g, float b, float a, const std::string& str)
         {
-            GLFN(GLUSEPROGRAM, glUseProgram)
-                GLFN(GLUNIFORM4F, glUniform4f)
-                glUseProgram(program_);
-            glUniform4f(frag_fgcolour_location_, r, g, b, a);
+            set_colour(fg_colour_, frag_fgcolour_location_, r, g, b, a);
             return str;
         }
         void background(float r, float g, float b, float a = 1.0f)
         {
-            GLFN(GLUSEPROGRAM, glUseProgram)
-            GLFN(GLUNIFORM4F, glUniform4f)
-            glUseProgram(program_);
-            glUniform4f(frag_bgcolour_location_, r, g, b, a);
+            set_colour(bg_colour_, frag_bgcolour_location_, r, g, b, a);
         }
         void colour(float fg_r, float fg_g, float fg_b, float fg_a, float bg_r, float bg_g, float bg_b, float bg_a)
         {
-            GLFN(GLUSEPROGRAM, glUseProgram)
-            GLFN(GLUNIFORM4F, glUniform4f)
-            glUseProgram(program_);
-            glUniform4f(frag_fgcolour_location_, fg_r, fg_g, fg_b, fg_a);
-            glUniform4f(frag_bgcolour_location_, bg_r, bg_g, bg_b, bg_a);
+            set_colour(fg_colour_, frag_fgcolour_location_, fg_r, fg_g, fg_b, fg_a);
+            set_colour(bg_colour_, frag_bgcolour_location_, bg_r, bg_g, bg_b, bg_a);
         }
 
         // Dimensions....
@@ -255,6 +264,7 @@ namespace glo
         // Draw the frame...
         void draw_frame(std::function<void()> callback = nullptr)
         {
+            gpu_scope scope("hud");
             render_wrapper rw(this);
 
             // Is there a callback?
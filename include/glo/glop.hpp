@@ -1,6 +1,11 @@
 #ifndef GLOP_HPP
 #define GLOP_HPP
 
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
 // --- Windows Platform ---
 #ifndef GLO_WIN
 
@@ -37,11 +42,184 @@
 #ifndef GLO_X
 
 #if defined(__linux__) || defined(__unix__)
+
+// Define GLO platform...
 #define GLO_X
+
+// X.org includes...
+#include <X11/Xlib.h>
+#include <GL/gl.h>             // includes the system glext.h
+#include <GL/glx.h>
+
+// Headless (EGL) contexts resolve through EGL, windowed through GLX...
+#ifdef GLO_USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define GLFN_LOAD(name) eglGetProcAddress(#name)
+#else
+#define GLFN_LOAD(name) glXGetProcAddress(reinterpret_cast<const GLubyte*>(#name))
+#endif // GLO_USE_EGL
+
+// GL Function macros...
+#define GLFN_PROTOTYPE(prototype) PFN ## prototype ## PROC
+#define GLFN_DECLARE(prototype, name) GLFN_PROTOTYPE(prototype) name;
+#define GLFN_DEFINE(prototype, name) name = (GLFN_PROTOTYPE(prototype))GLFN_LOAD(name);
+#define GLFN(prototype, name) GLFN_PROTOTYPE(prototype) name = (GLFN_PROTOTYPE(prototype))GLFN_LOAD(name);
+
+// platform string type
+#define glwindow_str std::wstring
+
+// Platform specific compiler warning...
+#define GLO_WARNING(msg)
+
 #endif
 
 #endif
 // --- X.org Platform ---
 
+// --- GL dispatch table ---
+#ifdef GLFN_DEFINE
+
+// GL entry points resolved once per context (prototype, name)...
+#define GLO_GL_FUNCTIONS(fn) \
+    fn(GLACTIVETEXTURE, glActiveTexture) \
+    fn(GLATTACHSHADER, glAttachShader) \
+    fn(GLBINDBUFFER, glBindBuffer) \
+    fn(GLBINDFRAMEBUFFER, glBindFramebuffer) \
+    fn(GLBINDVERTEXARRAY, glBindVertexArray) \
+    fn(GLBUFFERDATA, glBufferData) \
+    fn(GLBUFFERSTORAGE, glBufferStorage) \
+    fn(GLCHECKFRAMEBUFFERSTATUS, glCheckFramebufferStatus) \
+    fn(GLCLIENTWAITSYNC, glClientWaitSync) \
+    fn(GLCOMPILESHADER, glCompileShader) \
+    fn(GLCOMPRESSEDTEXIMAGE2D, glCompressedTexImage2D) \
+    fn(GLCOMPRESSEDTEXSUBIMAGE2D, glCompressedTexSubImage2D) \
+    fn(GLCREATEPROGRAM, glCreateProgram) \
+    fn(GLCREATESHADER, glCreateShader) \
+    fn(GLDELETEBUFFERS, glDeleteBuffers) \
+    fn(GLDELETEQUERIES, glDeleteQueries) \
+    fn(GLDELETESHADER, glDeleteShader) \
+    fn(GLDELETESYNC, glDeleteSync) \
+    fn(GLDETACHSHADER, glDetachShader) \
+    fn(GLDRAWBUFFERS, glDrawBuffers) \
+    fn(GLENABLEVERTEXATTRIBARRAY, glEnableVertexAttribArray) \
+    fn(GLFENCESYNC, glFenceSync) \
+    fn(GLFRAMEBUFFERTEXTURE, glFramebufferTexture) \
+    fn(GLGENBUFFERS, glGenBuffers) \
+    fn(GLGENERATEMIPMAP, glGenerateMipmap) \
+    fn(GLGENFRAMEBUFFERS, glGenFramebuffers) \
+    fn(GLGENQUERIES, glGenQueries) \
+    fn(GLGENVERTEXARRAYS, glGenVertexArrays) \
+    fn(GLGETINTEGER64V, glGetInteger64v) \
+    fn(GLGETPROGRAMINFOLOG, glGetProgramInfoLog) \
+    fn(GLGETPROGRAMIV, glGetProgramiv) \
+    fn(GLGETQUERYOBJECTIV, glGetQueryObjectiv) \
+    fn(GLGETQUERYOBJECTUI64V, glGetQueryObjectui64v) \
+    fn(GLGETSHADERINFOLOG, glGetShaderInfoLog) \
+    fn(GLGETSHADERIV, glGetShaderiv) \
+    fn(GLGETSTRINGI, glGetStringi) \
+    fn(GLGETUNIFORMLOCATION, glGetUniformLocation) \
+    fn(GLLINKPROGRAM, glLinkProgram) \
+    fn(GLMAPBUFFERRANGE, glMapBufferRange) \
+    fn(GLQUERYCOUNTER, glQueryCounter) \
+    fn(GLSHADERSOURCE, glShaderSource) \
+    fn(GLTEXSTORAGE2D, glTexStorage2D) \
+    fn(GLUNIFORM1I, glUniform1i) \
+    fn(GLUNIFORM2F, glUniform2f) \
+    fn(GLUNIFORM4F, glUniform4f) \
+    fn(GLUNMAPBUFFER, glUnmapBuffer) \
+    fn(GLUSEPROGRAM, glUseProgram) \
+    fn(GLVERTEXATTRIBPOINTER, glVertexAttribPointer)
+
+namespace glo
+{
+    // Table of GL entry points, loaded once when a context is created and made current...
+    struct gl
+    {
+        GLO_GL_FUNCTIONS(GLFN_DECLARE)
+
+        // resolve every entry point for the context current on this thread...
+        void load() { GLO_GL_FUNCTIONS(GLFN_DEFINE) supported_.clear(); }
+
+        // the context has a feature, core since major.minor or through the extension, answered once per context (call
+        // with it current). A resolved entry point alone says nothing, GLX and EGL resolve any name...
+        bool supports(int major, int minor, const char* extension) const
+        {
+            auto found = supported_.find(extension);
+            if (found == supported_.end())
+                found = supported_.emplace(extension, query(major, minor, extension)).first;
+            return found->second;
+        }
+
+        // the table of the context current on this thread...
+        static const gl& current()
+        {
+            if (const gl* table = current_table())
+                return *table;
+
+            // context not created by glo, resolve once for this thread (once one is current, wgl
+            // resolves nothing without a context)...
+            static thread_local gl fallback;
+            static thread_local bool fallback_loaded = false;
+            if (!fallback_loaded && context_current())
+            {
+                fallback.load();
+                fallback_loaded = true;
+            }
+            return fallback;
+        }
+        static void current(const gl* table) { current_table() = table; }
+
+    private:
+        bool query(int major, int minor, const char* extension) const
+        {
+            int version_major = 0, version_minor = 0;
+            const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+            if (!version || std::sscanf(version, "%d.%d", &version_major, &version_minor) != 2)
+                return false;
+            if (version_major > major || (version_major == major && version_minor >= minor))
+                return true;
+
+            // 3.0 on lists extensions one at a time, before that as one string...
+            if (version_major >= 3 && glGetStringi)
+            {
+                GLint extensions = 0;
+                glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+                for (GLint e = 0; e < extensions; ++e)
+                {
+                    const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(e)));
+                    if (name && std::strcmp(name, extension) == 0)
+                        return true;
+                }
+                return false;
+            }
+            const char* all = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+            const std::size_t length = std::strlen(extension);
+            for (const char* at = all; at && (at = std::strstr(at, extension)); at += length)
+                if ((at == all || at[-1] == ' ') && (at[length] == ' ' || at[length] == '\0'))
+                    return true;
+            return false;
+        }
+
+        mutable std::map<std::string, bool> supported_;
+
+        static bool context_current()
+        {
+#if defined(GLO_WIN)
+            return wglGetCurrentContext() != NULL;
+#elif defined(GLO_USE_EGL)
+            return eglGetCurrentContext() != EGL_NO_CONTEXT;
+#else
+            return glXGetCurrentContext() != NULL;
+#endif
+        }
+
+        static const gl*& current_table() { static thread_local const gl* table = nullptr; return table; }
+    };
+}
+
+#endif // GLFN_DEFINE
+// --- GL dispatch table ---
+
 #endif // GLOP_HPP
 
@@ -0,0 +1,555 @@
+// GLO pixel formats, conversion between the layouts images are read, captured and uploaded in.
+// Rows go through linear float RGBA (SSE2/AVX2/F16C when the compiler targets them, scalar otherwise),
+// common byte swizzles skip it, large images are split across threads.
+
+#ifndef GLOPF_HPP
+#define GLOPF_HPP
+
+#include "glot.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace glo
+{
+    enum class pixel_format { rgb8, rgba8, bgra8, rgba16f, rgb32f, rgba32f };
+
+    // conversion options, combined with |...
+    enum pixel_flags : unsigned int
+    {
+        pixel_none = 0,
+        pixel_premultiply = 1,      // colour multiplied by alpha (in linear space)
+        pixel_srgb_decode = 2,      // source colour is sRGB encoded, made linear
+        pixel_srgb_encode = 4,      // destination colour is sRGB encoded
+    };
+
+    static std::size_t pixel_bytes(pixel_format format)
+    {
+        switch (format)
+        {
+        case pixel_format::rgb8: return 3;
+        case pixel_format::rgba8: return 4;
+        case pixel_format::bgra8: return 4;
+        case pixel_format::rgba16f: return 8;
+        case pixel_format::rgb32f: return 12;
+        case pixel_format::rgba32f: return 16;
+        }
+        return 0;
+    }
+
+    // the format an image's channels_ (bytes per pixel) stand for...
+    static pixel_format image_format(const image_view& img)
+    {
+        switch (img.channels_)
+        {
+        case 3: return pixel_format::rgb8;
+        case 4: return pixel_format::rgba8;
+        case 8: return pixel_format::rgba16f;
+        case 12: return pixel_format::rgb32f;
+        case 16: return pixel_format::rgba32f;
+        }
+        throw std::runtime_error("glo::image_format unsupported channels.");
+    }
+
+    static float half_to_float(std::uint16_t h)
+    {
+        std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000u) << 16;
+        std::uint32_t exponent = (h >> 10) & 0x1Fu;
+        std::uint32_t mantissa = h & 0x3FFu;
+        if (!exponent)
+        {
+            // zero or subnormal...
+            float f = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -f : f;
+        }
+        std::uint32_t bits = exponent == 0x1Fu ? sign | 0x7F800000u | (mantissa << 13) : sign | ((exponent + 112) << 23) | (mantissa << 13);
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    // rounded to nearest even, overflow to infinity...
+    static std::uint16_t float_to_half(float f)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        std::uint32_t sign = (bits >> 16) & 0x8000u;
+        std::uint32_t abs = bits & 0x7FFFFFFFu;
+
+        if (abs >= 0x7F800000u)
+            return static_cast<std::uint16_t>(sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0));
+        if (abs >= 0x477FF000u)
+            return static_cast<std::uint16_t>(sign | 0x7C00u);
+        if (abs < 0x38800000u)
+        {
+            // subnormal, below 2^-25 is zero...
+            if (abs < 0x33000000u)
+                return static_cast<std::uint16_t>(sign);
+            std::uint32_t shift = 126 - (abs >> 23);
+            std::uint32_t mantissa = (abs & 0x7FFFFFu) | 0x800000u;
+            std::uint32_t half = mantissa >> shift;
+            std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+            std::uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1)))
+                ++half;
+            return static_cast<std::uint16_t>(sign | half);
+        }
+
+        // rebias, a rounding carry moves into the exponent (and to infinity) as it should...
+        std::uint32_t half = (abs - 0x38000000u) >> 13;
+        std::uint32_t remainder = abs & 0x1FFFu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1)))
+            ++half;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+
+    static float srgb_to_linear(float c)
+    {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linear_to_srgb(float l)
+    {
+        return l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // sRGB bytes to linear, exact...
+    static const float* srgb_decode_table()
+    {
+        static const std::vector<float> table = []()
+            {
+                std::vector<float> t(256);
+                for (int c = 0; c < 256; ++c)
+                    t[c] = srgb_to_linear(c / 255.0f);
+                return t;
+            }();
+        return &table.front();
+    }
+
+    // linear to sRGB bytes, fine enough steps to be within a level of exact near black...
+    static const int srgb_encode_steps = 16384;
+    static const unsigned char* srgb_encode_table()
+    {
+        static const std::vector<unsigned char> table = []()
+            {
+                std::vector<unsigned char> t(srgb_encode_steps);
+                for (int l = 0; l < srgb_encode_steps; ++l)
+                    t[l] = static_cast<unsigned char>(linear_to_srgb(l / static_cast<float>(srgb_encode_steps - 1)) * 255.0f + 0.5f);
+                return t;
+            }();
+        return &table.front();
+    }
+
+    // pixels per pass through the float row, small enough to stay in L1...
+    static const std::size_t pixel_chunk = 256;
+
+    // bytes to float RGBA...
+    static void pixels_load8(const unsigned char* src, bool bgra, float* out, std::size_t count)
+    {
+        std::size_t p = 0;
+#if defined(GLO_AVX2)
+        const __m256 scale8 = _mm256_set1_ps(1.0f / 255.0f);
+        for (; p + 2 <= count; p += 2)
+        {
+            __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + p * 4)))), scale8);
+            if (bgra)
+                v = _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+            _mm256_storeu_ps(out + p * 4, v);
+        }
+#elif defined(GLO_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+        for (; p + 4 <= count; p += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * 4));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            __m128 px[4] = {
+                _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)),
+                _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)) };
+            for (int i = 0; i < 4; ++i)
+            {
+                __m128 f = _mm_mul_ps(px[i], scale);
+                if (bgra)
+                    f = _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 0, 1, 2));
+                _mm_storeu_ps(out + (p + i) * 4, f);
+            }
+        }
+#endif
+        for (; p < count; ++p)
+        {
+            const unsigned char* s = src + p * 4;
+            float* o = out + p * 4;
+            o[0] = s[bgra ? 2 : 0] / 255.0f;
+            o[1] = s[1] / 255.0f;
+            o[2] = s[bgra ? 0 : 2] / 255.0f;
+            o[3] = s[3] / 255.0f;
+        }
+    }
+
+    // float RGBA to bytes, clamped (NaN to 0) and rounded...
+    static void pixels_store8(const float* in, bool bgra, unsigned char* dst, std::size_t count)
+    {
+        std::size_t p = 0;
+#if defined(GLO_AVX2)
+        const __m256 zero8 = _mm256_setzero_ps();
+        const __m256 one8 = _mm256_set1_ps(1.0f);
+        const __m256 scale8 = _mm256_set1_ps(255.0f);
+        const __m256 half8 = _mm256_set1_ps(0.5f);
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        for (; p + 8 <= count; p += 8)
+        {
+            __m256i q[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                __m256 v = _mm256_loadu_ps(in + (p + i * 2) * 4);
+                if (bgra)
+                    v = _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+                v = _mm256_min_ps(_mm256_max_ps(v, zero8), one8);
+                q[i] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale8), half8));
+            }
+            // packs work within 128 bit lanes, the permute puts the pixels back in order...
+            __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(q[0], q[1]), _mm256_packs_epi32(q[2], q[3]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + p * 4), _mm256_permutevar8x32_epi32(bytes, order));
+        }
+#elif defined(GLO_SSE2)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; p + 4 <= count; p += 4)
+        {
+            __m128i q[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                __m128 v = _mm_loadu_ps(in + (p + i) * 4);
+                if (bgra)
+                    v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+                v = _mm_min_ps(_mm_max_ps(v, zero), one);
+                q[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 4), _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3])));
+        }
+#endif
+        for (; p < count; ++p)
+        {
+            const float* i = in + p * 4;
+            unsigned char* d = dst + p * 4;
+            for (int c = 0; c < 4; ++c)
+            {
+                float v = i[c] > 0.0f ? (i[c] < 1.0f ? i[c] : 1.0f) : 0.0f;
+                d[c] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+            }
+            if (bgra)
+                std::swap(d[0], d[2]);
+        }
+    }
+
+    static void pixels_load16f(const std::uint16_t* src, float* out, std::size_t count)
+    {
+        std::size_t v = 0, values = count * 4;
+#ifdef GLO_F16C
+        for (; v + 8 <= values; v += 8)
+            _mm256_storeu_ps(out + v, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + v))));
+#endif
+        for (; v < values; ++v)
+            out[v] = half_to_float(src[v]);
+    }
+
+    static void pixels_store16f(const float* in, std::uint16_t* dst, std::size_t count)
+    {
+        std::size_t v = 0, values = count * 4;
+#ifdef GLO_F16C
+        for (; v + 8 <= values; v += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + v), _mm256_cvtps_ph(_mm256_loadu_ps(in + v), _MM_FROUND_TO_NEAREST_INT));
+#endif
+        for (; v < values; ++v)
+            dst[v] = float_to_half(in[v]);
+    }
+
+    // colour times alpha, alpha kept...
+    static void pixels_premultiply(float* rgba, std::size_t count)
+    {
+        std::size_t p = 0;
+#ifdef GLO_SSE2
+        const __m128 alpha_lane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+        for (; p < count; ++p)
+        {
+            __m128 v = _mm_loadu_ps(rgba + p * 4);
+            __m128 a = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+            v = _mm_or_ps(_mm_andnot_ps(alpha_lane, _mm_mul_ps(v, a)), _mm_and_ps(alpha_lane, v));
+            _mm_storeu_ps(rgba + p * 4, v);
+        }
+#endif
+        for (; p < count; ++p)
+        {
+            float* v = rgba + p * 4;
+            v[0] *= v[3];
+            v[1] *= v[3];
+            v[2] *= v[3];
+        }
+    }
+
+    static bool pixels_byte_format(pixel_format format)
+    {
+        return format == pixel_format::rgb8 || format == pixel_format::rgba8 || format == pixel_format::bgra8;
+    }
+
+    // any format to linear (if decoding) float RGBA...
+    static void pixels_load(const unsigned char* src, pixel_format from, float* out, std::size_t count, unsigned int flags)
+    {
+        const bool decode = (flags & pixel_srgb_decode) != 0;
+        if (decode && pixels_byte_format(from))
+        {
+            // through the table rather than decoding each channel...
+            const float* table = srgb_decode_table();
+            const std::size_t bytes = pixel_bytes(from);
+            const bool bgra = from == pixel_format::bgra8;
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                const unsigned char* s = src + p * bytes;
+                float* o = out + p * 4;
+                o[0] = table[s[bgra ? 2 : 0]];
+                o[1] = table[s[1]];
+                o[2] = table[s[bgra ? 0 : 2]];
+                o[3] = bytes == 4 ? s[3] / 255.0f : 1.0f;
+            }
+            return;
+        }
+
+        switch (from)
+        {
+        case pixel_format::rgb8:
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                out[p * 4 + 0] = src[p * 3 + 0] / 255.0f;
+                out[p * 4 + 1] = src[p * 3 + 1] / 255.0f;
+                out[p * 4 + 2] = src[p * 3 + 2] / 255.0f;
+                out[p * 4 + 3] = 1.0f;
+            }
+            break;
+        case pixel_format::rgba8:
+        case pixel_format::bgra8:
+            pixels_load8(src, from == pixel_format::bgra8, out, count);
+            break;
+        case pixel_format::rgba16f:
+            pixels_load16f(reinterpret_cast<const std::uint16_t*>(src), out, count);
+            break;
+        case pixel_format::rgb32f:
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                std::memcpy(out + p * 4, src + p * 12, 12);
+                out[p * 4 + 3] = 1.0f;
+            }
+            break;
+        case pixel_format::rgba32f:
+            if (out != reinterpret_cast<const float*>(src))
+                std::memcpy(out, src, count * 16);
+            break;
+        }
+
+        if (decode)
+            for (std::size_t p = 0; p < count; ++p)
+                for (int c = 0; c < 3; ++c)
+                    out[p * 4 + c] = srgb_to_linear(out[p * 4 + c]);
+    }
+
+    // float RGBA to any format, encoding to sRGB if asked (rgba may be changed)...
+    static void pixels_store(float* rgba, pixel_format to, unsigned char* dst, std::size_t count, unsigned int flags)
+    {
+        const bool encode = (flags & pixel_srgb_encode) != 0;
+        if (encode && pixels_byte_format(to))
+        {
+            const unsigned char* table = srgb_encode_table();
+            const std::size_t bytes = pixel_bytes(to);
+            const bool bgra = to == pixel_format::bgra8;
+            const float steps = static_cast<float>(srgb_encode_steps - 1);
+            for (std::size_t p = 0; p < count; ++p)
+            {
+                const float* i = rgba + p * 4;
+                unsigned char* d = dst + p * bytes;
+                for (int c = 0; c < 3; ++c)
+                {
+                    float v = i[c] > 0.0f ? (i[c] < 1.0f ? i[c] : 1.0f) : 0.0f;
+                    d[bgra ? 2 - c : c] = table[static_cast<int>(v * steps + 0.5f)];
+                }
+                if (bytes == 4)
+                {
+                    float a = i[3] > 0.0f ? (i[3] < 1.0f ? i[3] : 1.0f) : 0.0f;
+                    d[3] = static_cast<unsigned char>(a * 255.0f + 0.5f);
+                }
+            }
+            return;
+        }
+
+        if (encode)
+            for (std::size_t p = 0; p < count; ++p)
+                for (int c = 0; c < 3; ++c)
+                    rgba[p * 4 + c] = linear_to_srgb(rgba[p * 4 + c]);
+
+        switch (to)
+        {
+        case pixel_format::rgb8:
+            for (std::size_t p = 0; p < count; ++p)
+                for (int c = 0; c < 3; ++c)
+                {
+                    float v = rgba[p * 4 + c] > 0.0f ? (rgba[p * 4 + c] < 1.0f ? rgba[p * 4 + c] : 1.0f) : 0.0f;
+                    dst[p * 3 + c] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+                }
+            break;
+        case pixel_format::rgba8:
+        case pixel_format::bgra8:
+            pixels_store8(rgba, to == pixel_format::bgra8, dst, count);
+            break;
+        case pixel_format::rgba16f:
+            pixels_store16f(rgba, reinterpret_cast<std::uint16_t*>(dst), count);
+            break;
+        case pixel_format::rgb32f:
+            for (std::size_t p = 0; p < count; ++p)
+                std::memcpy(dst + p * 12, rgba + p * 4, 12);
+            break;
+        case pixel_format::rgba32f:
+            if (reinterpret_cast<float*>(dst) != rgba)
+                std::memcpy(dst, rgba, count * 16);
+            break;
+        }
+    }
+
+    // byte layouts with no maths to do, swizzled directly, false if not one of them...
+    static bool pixels_swizzle(const unsigned char* src, pixel_format from, unsigned char* dst, pixel_format to, std::size_t count)
+    {
+        const bool swap = (from == pixel_format::bgra8) != (to == pixel_format::bgra8);
+        std::size_t p = 0;
+
+        if (swap && (from == pixel_format::rgba8 || from == pixel_format::bgra8) && (to == pixel_format::rgba8 || to == pixel_format::bgra8))
+        {
+#if defined(GLO_AVX2)
+            const __m256i swap_rb8 = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            for (; p + 8 <= count; p += 8)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + p * 4), _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + p * 4)), swap_rb8));
+#elif defined(GLO_SSE2)
+            const __m128i green_alpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+            const __m128i low = _mm_set1_epi32(0xFF);
+            for (; p + 4 <= count; p += 4)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * 4));
+                v = _mm_or_si128(_mm_and_si128(v, green_alpha), _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, low), 16), _mm_and_si128(_mm_srli_epi32(v, 16), low)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 4), v);
+            }
+#endif
+            for (; p < count; ++p)
+            {
+                dst[p * 4 + 0] = src[p * 4 + 2];
+                dst[p * 4 + 1] = src[p * 4 + 1];
+                dst[p * 4 + 2] = src[p * 4 + 0];
+                dst[p * 4 + 3] = src[p * 4 + 3];
+            }
+            return true;
+        }
+
+        if (from == pixel_format::rgb8 && (to == pixel_format::rgba8 || to == pixel_format::bgra8))
+        {
+#ifdef GLO_SSSE3
+            // 4 pixels from each 16 byte load (the last 4 bytes unused), alpha or'd in...
+            const __m128i expand = swap
+                ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+                : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            for (; p + 6 <= count; p += 4)
+            {
+                __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * 3)), expand);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * 4), _mm_or_si128(v, alpha));
+            }
+#endif
+            for (; p < count; ++p)
+            {
+                dst[p * 4 + 0] = src[p * 3 + (swap ? 2 : 0)];
+                dst[p * 4 + 1] = src[p * 3 + 1];
+                dst[p * 4 + 2] = src[p * 3 + (swap ? 0 : 2)];
+                dst[p * 4 + 3] = 255;
+            }
+            return true;
+        }
+
+        if ((from == pixel_format::rgba8 || from == pixel_format::bgra8) && to == pixel_format::rgb8)
+        {
+            for (; p < count; ++p)
+            {
+                dst[p * 3 + 0] = src[p * 4 + (swap ? 2 : 0)];
+                dst[p * 3 + 1] = src[p * 4 + 1];
+                dst[p * 3 + 2] = src[p * 4 + (swap ? 0 : 2)];
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // count pixels from one format to another, src and dst must not overlap...
+    static void pixels_convert(const void* src, pixel_format from, void* dst, pixel_format to, std::size_t count, unsigned int flags = pixel_none)
+    {
+        const unsigned char* s = static_cast<const unsigned char*>(src);
+        unsigned char* d = static_cast<unsigned char*>(dst);
+
+        // sRGB to sRGB is only undone for premultiplying...
+        if ((flags & (pixel_srgb_decode | pixel_srgb_encode)) == (pixel_srgb_decode | pixel_srgb_encode) && !(flags & pixel_premultiply))
+            flags &= ~(pixel_srgb_decode | pixel_srgb_encode);
+
+        if (!flags)
+        {
+            if (from == to)
+            {
+                std::memcpy(d, s, count * pixel_bytes(from));
+                return;
+            }
+            if (pixels_swizzle(s, from, d, to, count))
+                return;
+        }
+
+        const std::size_t from_bytes = pixel_bytes(from), to_bytes = pixel_bytes(to);
+        float row[pixel_chunk * 4];
+        for (std::size_t first = 0; first < count; first += pixel_chunk)
+        {
+            std::size_t n = count - first < pixel_chunk ? count - first : pixel_chunk;
+
+            // float RGBA destinations are worked on in place...
+            float* rgba = to == pixel_format::rgba32f && !(flags & pixel_srgb_encode) ? reinterpret_cast<float*>(d + first * to_bytes) : row;
+            pixels_load(s + first * from_bytes, from, rgba, n, flags);
+            if (flags & pixel_premultiply)
+                pixels_premultiply(rgba, n);
+            pixels_store(rgba, to, d + first * to_bytes, n, flags);
+        }
+    }
+
+    // a new image in another format, large images split by rows across threads (image_threads)...
+    static image image_convert(const image_view& img, pixel_format from, pixel_format to, unsigned int flags = pixel_none)
+    {
+        if (pixel_bytes(from) != static_cast<std::size_t>(img.channels_))
+            throw std::runtime_error("glo::image_convert format differs from the image's.");
+
+        const std::size_t pixels = static_cast<std::size_t>(img.width_) * img.height_;
+        image result(img.width_, img.height_, static_cast<int>(pixel_bytes(to)), std::vector<unsigned char>(pixels * pixel_bytes(to)));
+        if (!pixels || !img.data_)
+            return result;
+
+        const std::size_t from_row = img.width_ * pixel_bytes(from), to_row = img.width_ * pixel_bytes(to);
+        const unsigned char* src = img.data_;
+        unsigned char* dst = result.pixels();
+        image_bands(img.height_, image_threads(img), [=](int first, int last)
+            {
+                pixels_convert(src + first * from_row, from, dst + first * to_row, to, static_cast<std::size_t>(last - first) * img.width_, flags);
+            });
+        return result;
+    }
+
+    // from the format the image's channels_ stand for (image_format)...
+    static image image_convert(const image_view& img, pixel_format to, unsigned int flags = pixel_none)
+    {
+        return image_convert(img, image_format(img), to, flags);
+    }
+}
+
+#endif // GLOPF_HPP
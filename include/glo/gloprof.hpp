@@ -0,0 +1,194 @@
+// GLO GPU profiler, time spent by the GPU in named (nestable) scopes, e.g. glo::gpu_scope scope("hud");
+// Timestamps are queried into a ring of frames and read back frames later, so reading never stalls the pipeline.
+
+#ifndef GLOPROF_HPP
+#define GLOPROF_HPP
+
+#include "glop.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace glo
+{
+    class gpu_profiler
+    {
+    public:
+        // frames in flight before a frame's results are read...
+        static constexpr int latency = 4;
+
+        struct timing
+        {
+            std::string name_;
+            int depth_;                 // nesting, 0 for outer scopes
+            double milliseconds_;
+        };
+
+        // the profiler of the context current on this thread (query objects aren't shared)...
+        static gpu_profiler& current()
+        {
+            const gl* table = &gl::current();
+            auto found = profilers().find(table);
+            if (found == profilers().end())
+                found = profilers().emplace(table, gpu_profiler(table)).first;
+            return found->second;
+        }
+
+        // forget a context's profiler as the context is freed (a later one may get the same table address), its queries
+        // are deleted if it's current, otherwise they go with the context...
+        static void release(const gl* table)
+        {
+            auto found = profilers().find(table);
+            if (found == profilers().end())
+                return;
+            if (&gl::current() == table)
+                found->second.free();
+            profilers().erase(found);
+        }
+
+        // off by default, scopes cost nothing until enabled...
+        void enable(bool enabled) { enabled_ = enabled; }
+        bool enabled() const { return enabled_; }
+
+        void begin(const char* name)
+        {
+            if (!enabled_)
+                return;
+
+            frame_slot& slot = ring_[slot_];
+            if (slot.count_ == slot.records_.size())
+                slot.records_.emplace_back();
+            record& r = slot.records_[slot.count_];
+            r.name_ = name;
+            r.depth_ = static_cast<int>(open_.size());
+            r.begin_ = query(slot);
+            r.end_ = 0;
+            gl_->glQueryCounter(r.begin_, GL_TIMESTAMP);
+            open_.push_back(slot.count_++);
+        }
+
+        void end()
+        {
+            if (!enabled_ || open_.empty())
+                return;
+
+            frame_slot& slot = ring_[slot_];
+            record& r = slot.records_[open_.back()];
+            open_.pop_back();
+            r.end_ = query(slot);
+            gl_->glQueryCounter(r.end_, GL_TIMESTAMP);
+        }
+
+        // frame boundary (after the swap), collects the oldest frame if the GPU has finished it...
+        void frame()
+        {
+            open_.clear();
+            slot_ = (slot_ + 1) % latency;
+
+            frame_slot& slot = ring_[slot_];
+            if (slot.count_ && slot.queries_used_)
+            {
+                // queries complete in order, the last one being available means all are...
+                GLint available = 0;
+                gl_->glGetQueryObjectiv(slot.queries_[slot.queries_used_ - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available)
+                {
+                    results_.resize(slot.count_);
+                    for (std::size_t r = 0; r < slot.count_; ++r)
+                    {
+                        const record& rec = slot.records_[r];
+                        GLuint64 begin = 0, end = 0;
+                        gl_->glGetQueryObjectui64v(rec.begin_, GL_QUERY_RESULT, &begin);
+                        if (rec.end_)
+                            gl_->glGetQueryObjectui64v(rec.end_, GL_QUERY_RESULT, &end);
+                        results_[r].name_ = rec.name_;
+                        results_[r].depth_ = rec.depth_;
+                        results_[r].milliseconds_ = end > begin ? static_cast<double>(end - begin) / 1000000.0 : 0.0;
+                    }
+                }
+            }
+
+            // a frame still pending after the ring went round is dropped rather than waited on...
+            slot.count_ = 0;
+            slot.queries_used_ = 0;
+        }
+
+        // scopes of the latest completed frame, in begin order...
+        const std::vector<timing>& results() const { return results_; }
+
+        // total of a scope in the latest completed frame (e.g. "hud"), 0 if not found...
+        double milliseconds(const std::string& name) const
+        {
+            double total = 0.0;
+            for (auto r = results_.begin(); r != results_.end(); ++r)
+                if (r->name_ == name)
+                    total += r->milliseconds_;
+            return total;
+        }
+
+        void free()
+        {
+            for (int s = 0; s < latency; ++s)
+            {
+                if (!ring_[s].queries_.empty())
+                    gl_->glDeleteQueries(static_cast<GLsizei>(ring_[s].queries_.size()), &ring_[s].queries_.front());
+                ring_[s] = frame_slot();
+            }
+            open_.clear();
+        }
+
+    private:
+        struct record
+        {
+            std::string name_;
+            int depth_ = 0;
+            GLuint begin_ = 0;
+            GLuint end_ = 0;
+        };
+
+        // queries and scopes of one frame, grown once then reused...
+        struct frame_slot
+        {
+            std::vector<GLuint> queries_;
+            std::size_t queries_used_ = 0;
+            std::vector<record> records_;
+            std::size_t count_ = 0;
+        };
+
+        gpu_profiler(const gl* table) : gl_(table) {}
+
+        static std::map<const gl*, gpu_profiler>& profilers() { static thread_local std::map<const gl*, gpu_profiler> all; return all; }
+
+        GLuint query(frame_slot& slot)
+        {
+            if (slot.queries_used_ == slot.queries_.size())
+            {
+                GLuint id = 0;
+                gl_->glGenQueries(1, &id);
+                slot.queries_.push_back(id);
+            }
+            return slot.queries_[slot.queries_used_++];
+        }
+
+        const gl* gl_;
+        bool enabled_ = false;
+        frame_slot ring_[latency];
+        int slot_ = 0;
+        std::vector<std::size_t> open_;
+        std::vector<timing> results_;
+    };
+
+    // time the GPU work issued while in scope...
+    class gpu_scope
+    {
+    public:
+        gpu_scope(const char* name) : profiler_(gpu_profiler::current()) { profiler_.begin(name); }
+        ~gpu_scope() { profiler_.end(); }
+
+    private:
+        gpu_profiler& profiler_;
+    };
+}
+
+#endif // GLOPROF_HPP
@@ -2,6 +2,7 @@
 #define GLOQ_HPP
 
 #include "glop.hpp"
+#include "gloprof.hpp"
 #include "glos.hpp"
 
 #include <stdexcept>
@@ -9,56 +10,50 @@
 
 namespace glo
 {
+    // A unit quad, its buffers and program are created on first draw (the program only if drawing a frame)...
     class quad
     {
-        GLuint points_, uvs_, indexes_, vao_;
-        GLuint program_;
-
-        GLFN(GLGENVERTEXARRAYS, glGenVertexArrays)
-        GLFN(GLBINDVERTEXARRAY, glBindVertexArray)
-        GLFN(GLGENBUFFERS, glGenBuffers)
-        GLFN(GLBINDBUFFER, glBindBuffer)
-        GLFN(GLBUFFERDATA, glBufferData)
-        GLFN(GLENABLEVERTEXATTRIBARRAY, glEnableVertexAttribArray)
-        GLFN(GLVERTEXATTRIBPOINTER, glVertexAttribPointer)
-        GLFN(GLACTIVETEXTURE, glActiveTexture)
-        GLFN(GLGETUNIFORMLOCATION, glGetUniformLocation)
-        GLFN(GLUNIFORM1I, glUniform1i)
-        GLFN(GLUSEPROGRAM, glUseProgram)
+        mutable GLuint points_ = 0, uvs_ = 0, indexes_ = 0, vao_ = 0;
+        GLuint program_ = 0;
+        GLint frame_location_ = -1;
 
-    public:
-        quad()
+        // entry points of the context this quad was created in...
+        const gl* gl_ = &gl::current();
+
+        void create_buffers() const
         {
             std::vector<GLfloat> uvs = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
             std::vector<GLfloat> points = { -1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f };
             std::vector<GLuint> indexes = { 0, 1, 2, 2, 3, 0 };
 
-            glGenVertexArrays(1, &vao_);
-            glBindVertexArray(vao_);
+            gl_->glGenVertexArrays(1, &vao_);
+            gl_->glBindVertexArray(vao_);
 
             // points...
-            glGenBuffers(1, &points_);
-            glBindBuffer(GL_ARRAY_BUFFER, points_);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * points.size(), &points.front(), GL_STATIC_DRAW);
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+            gl_->glGenBuffers(1, &points_);
+            gl_->glBindBuffer(GL_ARRAY_BUFFER, points_);
+            gl_->glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * points.size(), &points.front(), GL_STATIC_DRAW);
+            gl_->glEnableVertexAttribArray(0);
+            gl_->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
 
             // uvs...
-            glGenBuffers(1, &uvs_);
-            glBindBuffer(GL_ARRAY_BUFFER, uvs_);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * uvs.size(), &uvs.front(), GL_STATIC_DRAW);
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
+            gl_->glGenBuffers(1, &uvs_);
+            gl_->glBindBuffer(GL_ARRAY_BUFFER, uvs_);
+            gl_->glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * uvs.size(), &uvs.front(), GL_STATIC_DRAW);
+            gl_->glEnableVertexAttribArray(1);
+            gl_->glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
             // Cache the indexes...
-            glGenBuffers(1, &indexes_);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexes_);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indexes.size(), &indexes.front(), GL_STATIC_DRAW);
-            glBindBuffer(GL_ARRAY_BUFFER, NULL);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, NULL);
-            glBindVertexArray(NULL);
-
+            gl_->glGenBuffers(1, &indexes_);
+            gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexes_);
+            gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indexes.size(), &indexes.front(), GL_STATIC_DRAW);
+            gl_->glBindBuffer(GL_ARRAY_BUFFER, NULL);
+            gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, NULL);
+            gl_->glBindVertexArray(NULL);
+        }
 
+        void create_program()
+        {
             GLuint vertex = glsl_compile(GL_VERTEX_SHADER, R"(
 				#version 410 core
 				layout(location = 0) in vec3 in_point;
@@ -83,29 +78,38 @@ namespace glo
 			)");
 
             program_ = glsl_link({ vertex, fragment });
+            frame_location_ = gl_->glGetUniformLocation(program_, "frame");
         }
 
+    public:
+        quad() {}
+
         virtual ~quad() {}
 
         void draw_frame() const
         {
-            glBindVertexArray(vao_);
-            glBindBuffer(GL_ARRAY_BUFFER, points_);
-            glBindBuffer(GL_ARRAY_BUFFER, uvs_);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexes_);
+            if (!vao_)
+                create_buffers();
+            gl_->glBindVertexArray(vao_);
+            gl_->glBindBuffer(GL_ARRAY_BUFFER, points_);
+            gl_->glBindBuffer(GL_ARRAY_BUFFER, uvs_);
+            gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexes_);
 
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-            glBindVertexArray(NULL);
-            glBindBuffer(GL_ARRAY_BUFFER, NULL);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, NULL);
+            gl_->glBindVertexArray(NULL);
+            gl_->glBindBuffer(GL_ARRAY_BUFFER, NULL);
+            gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, NULL);
         }
         void draw_frame(GLuint frame)
         {
-            glUseProgram(program_);
-            glActiveTexture(GL_TEXTURE0);
+            gpu_scope scope("quad");
+            if (!program_)
+                create_program();
+            gl_->glUseProgram(program_);
+            gl_->glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, frame);
-            glUniform1i(glGetUniformLocation(program_, "frame"), 0);
+            gl_->glUniform1i(frame_location_, 0);
             draw_frame();
             glBindTexture(GL_TEXTURE_2D, NULL);
         }
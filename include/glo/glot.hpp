@@ -6,8 +6,34 @@
 
 #include "glop.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+// SSE2 is baseline on x64, SSSE3 (byte shuffles) only when the compiler targets it (e.g. -mssse3, /arch:AVX)...
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLO_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define GLO_SSSE3
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define GLO_AVX2
+#include <immintrin.h>
+#endif
+// half float conversions, msvc has no flag for them but every AVX2 target has them...
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define GLO_F16C
+#include <immintrin.h>
+#endif
+
 #ifdef GLO_USE_STB
 #define STB_IMAGE_IMPLEMENTATION
 #include "../stb/stb_image.h"
@@ -22,40 +48,233 @@ namespace glo
     {
         int width_;
         int height_;
-        int channels_;      // in bytes 4 = Unsigned byte RGBA, 16 = float RGBA
-        std::vector<unsigned char> data_;
+        int channels_;      // in bytes 4 = Unsigned byte RGBA, 8 = half float RGBA, 16 = float RGBA
+
+        image() : width_(0), height_(0), channels_(0) {}
+        image(int width, int height, int channels, std::vector<unsigned char> data = std::vector<unsigned char>())
+            : width_(width), height_(height), channels_(channels), data_(std::move(data)) {}
+
+        // copies own their pixels, an adopted buffer is copied into data_...
+        image(const image& other) : width_(other.width_), height_(other.height_), channels_(other.channels_), data_(other.data_)
+        {
+            if (other.adopted_)
+                data_.assign(other.adopted_.get(), other.adopted_.get() + other.bytes());
+        }
+        image(image&& other) = default;
+        image& operator=(const image& other)
+        {
+            if (this != &other)
+                *this = image(other);
+            return *this;
+        }
+        image& operator=(image&& other) = default;
+
+        // pixels allocated elsewhere (e.g. by a decoder) used where they are, deleter frees them with the image...
+        void adopt(unsigned char* pixels, std::function<void(unsigned char*)> deleter)
+        {
+            data_.clear();
+            data_.shrink_to_fit();
+            adopted_.reset(pixels, deleter);
+        }
+
+        // the pixels wherever they are held, nullptr if none...
+        unsigned char* pixels() { return adopted_ ? adopted_.get() : (data_.empty() ? nullptr : &data_.front()); }
+        const unsigned char* pixels() const { return adopted_ ? adopted_.get() : (data_.empty() ? nullptr : &data_.front()); }
+        std::size_t bytes() const { return adopted_ ? static_cast<std::size_t>(width_) * height_ * channels_ : data_.size(); }
+        bool empty() const { return !pixels(); }
+
+    private:
+        std::vector<unsigned char> data_;           // owned pixels, empty when adopted, so only through pixels()
+        std::shared_ptr<unsigned char> adopted_;
+    };
+
+    // pixels borrowed (e.g. from an image or a mapped file), they must outlive the view...
+    struct image_view
+    {
+        int width_;
+        int height_;
+        int channels_;
+        const unsigned char* data_;
+
+        image_view(int width, int height, int channels, const unsigned char* data)
+            : width_(width), height_(height), channels_(channels), data_(data) {}
+        image_view(const image& img)
+            : width_(img.width_), height_(img.height_), channels_(img.channels_), data_(img.pixels()) {}
     };
 
-    static void image_fliph(image& img)
+    // swap a pixel of N bytes through a register sized temporary...
+    template <std::size_t N>
+    static void image_pixel_swap(unsigned char* a, unsigned char* b)
     {
-        std::vector<unsigned char> new_data = img.data_;
-        for (int y = 0; y < img.height_; ++y)
+        unsigned char t[N];
+        std::memcpy(t, a, N);
+        std::memcpy(a, b, N);
+        std::memcpy(b, t, N);
+    }
+
+    // reverse a row of N byte pixels, the ends walking in a pixel at a time...
+    template <std::size_t N>
+    static void image_row_reverse(unsigned char* row, int width)
+    {
+        unsigned char* left = row;
+        unsigned char* right = row + (width - 1) * N;
+        for (; left < right; left += N, right -= N)
+            image_pixel_swap<N>(left, right);
+    }
+
+#ifdef GLO_SSE2
+    // 4 pixels per register, reversed with one shuffle, swapped 4 from each end...
+    template <>
+    inline void image_row_reverse<4>(unsigned char* row, int width)
+    {
+        unsigned char* left = row;
+        unsigned char* right = row + width * 4;
+        while (right - left >= 32)
         {
-            for (int x = 0; x < img.width_; ++x)
-            {
-                int source = ((y * img.width_) + x) * img.channels_;
-                int target = ((y * img.width_) + ((img.width_ - 1) - x)) * img.channels_;
-                for (unsigned int c = 0; c < static_cast<unsigned int>(img.channels_); ++c)
-                    new_data[target + c] = img.data_[source + c];
-            }
+            right -= 16;
+            __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left));
+            __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(left), _mm_shuffle_epi32(r, _MM_SHUFFLE(0, 1, 2, 3)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(right), _mm_shuffle_epi32(l, _MM_SHUFFLE(0, 1, 2, 3)));
+            left += 16;
         }
-        std::swap(img.data_, new_data);
+        for (right -= 4; left < right; left += 4, right -= 4)
+            image_pixel_swap<4>(left, right);
     }
+#endif // GLO_SSE2
 
-    static void image_flipv(image& img)
+#ifdef GLO_SSSE3
+    // 5 pixels (15 bytes) per register, reversed with one byte shuffle...
+    template <>
+    inline void image_row_reverse<3>(unsigned char* row, int width)
     {
-        std::vector<unsigned char> new_data = img.data_;
-        for (int y = 0; y < img.height_; ++y)
+        // the right block is loaded a byte early so neither load leaves the row...
+        const __m128i reverse_left = _mm_setr_epi8(12, 13, 14, 9, 10, 11, 6, 7, 8, 3, 4, 5, 0, 1, 2, 15);
+        const __m128i reverse_right = _mm_setr_epi8(13, 14, 15, 10, 11, 12, 7, 8, 9, 4, 5, 6, 1, 2, 3, 0);
+        unsigned char* left = row;
+        unsigned char* right = row + width * 3;
+        while (right - left >= 30)
         {
-            for (int x = 0; x < img.width_; ++x)
+            right -= 15;
+            unsigned char l[16], r[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(l), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left)), reverse_left));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(r), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right - 1)), reverse_right));
+            std::memcpy(left, r, 15);
+            std::memcpy(right, l, 15);
+            left += 15;
+        }
+        for (right -= 3; left < right; left += 3, right -= 3)
+            image_pixel_swap<3>(left, right);
+    }
+#endif // GLO_SSSE3
+
+    // pixels of any other size...
+    static void image_row_reverse(unsigned char* row, int width, std::size_t bytes)
+    {
+        unsigned char* left = row;
+        unsigned char* right = row + (width - 1) * bytes;
+        for (; left < right; left += bytes, right -= bytes)
+            std::swap_ranges(left, left + bytes, right);
+    }
+
+    static void image_fliph_rows(image& img, int first, int last)
+    {
+        const std::size_t stride = static_cast<std::size_t>(img.width_) * img.channels_;
+        for (int y = first; y < last; ++y)
+        {
+            unsigned char* row = img.pixels() + y * stride;
+            switch (img.channels_)
             {
-                int source = ((y * img.width_) + x) * img.channels_;
-                int target = ((((img.height_ - 1) - y) * img.width_) + x) * img.channels_;
-                for (unsigned int c = 0; c < static_cast<unsigned int>(img.channels_); ++c)
-                    new_data[target + c] = img.data_[source + c];
+            case 3: image_row_reverse<3>(row, img.width_); break;
+            case 4: image_row_reverse<4>(row, img.width_); break;
+            case 12: image_row_reverse<12>(row, img.width_); break;
+            case 16: image_row_reverse<16>(row, img.width_); break;
+            default: image_row_reverse(row, img.width_, img.channels_); break;
             }
         }
-        std::swap(img.data_, new_data);
+    }
+
+    // swap rows [first, last) of the top half with their mirrors, a row at a time through a buffer...
+    static void image_flipv_rows(image& img, int first, int last)
+    {
+        const std::size_t stride = static_cast<std::size_t>(img.width_) * img.channels_;
+        std::vector<unsigned char> buffer(stride);
+        for (int y = first; y < last; ++y)
+        {
+            unsigned char* top = img.pixels() + y * stride;
+            unsigned char* bottom = img.pixels() + (img.height_ - 1 - y) * stride;
+            std::memcpy(&buffer.front(), top, stride);
+            std::memcpy(top, bottom, stride);
+            std::memcpy(bottom, &buffer.front(), stride);
+        }
+    }
+
+    // split rows [0, rows) into bands, one per thread (the calling thread takes the first)...
+    template <typename fn>
+    static void image_bands(int rows, unsigned int threads, fn band)
+    {
+        if (threads > static_cast<unsigned int>(rows))
+            threads = rows > 0 ? static_cast<unsigned int>(rows) : 1;
+        if (threads <= 1)
+        {
+            band(0, rows);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threads; ++t)
+            workers.emplace_back(band, static_cast<int>(rows * t / threads), static_cast<int>(rows * (t + 1) / threads));
+        band(0, static_cast<int>(rows / threads));
+        for (auto w = workers.begin(); w != workers.end(); ++w)
+            w->join();
+    }
+
+    // threads worth using to flip or convert the image, 1 below about 4 megapixels...
+    static unsigned int image_threads(const image_view& img)
+    {
+        if (static_cast<std::size_t>(img.width_) * img.height_ < 4096 * 1024)
+            return 1;
+        unsigned int threads = std::thread::hardware_concurrency();
+        return threads ? std::min(threads, 8u) : 1;
+    }
+
+    // in place, each row reversed...
+    static void image_fliph(image& img, unsigned int threads = 1)
+    {
+        if (img.width_ <= 1 || img.empty())
+            return;
+        image_bands(img.height_, threads, [&img](int first, int last) { image_fliph_rows(img, first, last); });
+    }
+
+    // in place, rows swapped top to bottom...
+    static void image_flipv(image& img, unsigned int threads = 1)
+    {
+        if (img.height_ <= 1 || img.empty())
+            return;
+        image_bands(img.height_ / 2, threads, [&img](int first, int last) { image_flipv_rows(img, first, last); });
+    }
+
+    // GL formats for an image's channels_ (storage is sized, as immutable storage needs)...
+    static void texture_format(int channels, GLenum& internal_format, GLenum& format, GLenum& type)
+    {
+        switch (channels)
+        {
+        case 3: internal_format = GL_RGB8; format = GL_RGB; type = GL_UNSIGNED_BYTE; return;           // 24bit RGB (byte)
+        case 4: internal_format = GL_RGBA8; format = GL_RGBA; type = GL_UNSIGNED_BYTE; return;         // 32bit RGBA (byte)
+        case 8: internal_format = GL_RGBA16F; format = GL_RGBA; type = GL_HALF_FLOAT; return;          // 64bit RGBA (half float)
+        case 12: internal_format = GL_RGB32F; format = GL_RGB; type = GL_FLOAT; return;                // 96bit RGB (float)
+        case 16: internal_format = GL_RGBA32F; format = GL_RGBA; type = GL_FLOAT; return;              // 128bit RGBA (float)
+        }
+        throw std::runtime_error("glo::texture unsupported channels.");
+    }
+
+    // levels of a full mip chain...
+    static int texture_levels(int width, int height)
+    {
+        int levels = 1;
+        for (int size = std::max(width, height); size > 1; size >>= 1)
+            ++levels;
+        return levels;
     }
 
     // texture...
@@ -64,48 +283,119 @@ namespace glo
         GLuint id_;
         int width_;
         int height_;
+        int channels_ = 0;
+        int levels_ = 1;
+    protected:
+        // sized but not yet uploaded (see cache)...
+        texture(int width, int height) : id_(0), width_(width), height_(height) {}
+
+        // storage created elsewhere (e.g. compressed), owned from here on...
+        void assign(GLuint id, int width, int height, int levels)
+        {
+            texture::free();
+            id_ = id;
+            width_ = width;
+            height_ = height;
+            channels_ = 0;
+            levels_ = levels;
+        }
+
     public:
-        texture(const image& img, GLint filtering, GLint wrapping)
+        texture(const image_view& img, GLint filtering, GLint wrapping, bool mips = false)
             : id_(0), width_(img.width_), height_(img.height_)
         {
-            cache(img, filtering, wrapping);
+            cache(img, filtering, wrapping, mips);
+        }
+
+        // storage only, filled with update...
+        texture(int width, int height, int channels, GLint filtering, GLint wrapping, bool mips = false)
+            : id_(0), width_(width), height_(height)
+        {
+            allocate(width, height, channels, filtering, wrapping, mips ? texture_levels(width, height) : 1);
         }
 
         virtual ~texture() {}
 
         int image_width() const { return width_; }
         int image_height() const { return height_; }
+        int levels() const { return levels_; }
 
-        void cache(const image& img, GLint filtering, GLint wrapping)
+        // upload a whole image, storage is only reallocated (and the ID changes) when size, format or mips differ...
+        void cache(const image_view& img, GLint filtering, GLint wrapping, bool mips = false)
         {
-            if (!id_)
-                glGenTextures(1, &id_);
-            glBindTexture(GL_TEXTURE_2D, id_);
+            int levels = mips ? texture_levels(img.width_, img.height_) : 1;
+            if (!id_ || img.width_ != width_ || img.height_ != height_ || img.channels_ != channels_ || levels != levels_)
+                allocate(img.width_, img.height_, img.channels_, filtering, wrapping, levels);
+            else
+                parameters(filtering, wrapping);
+            if (img.data_)
+                update(0, 0, img.width_, img.height_, img);
+        }
 
-            switch (img.channels_)
+        // immutable storage (glTexStorage2D) for levels mips, a plain chain of glTexImage2D where unsupported...
+        void allocate(int width, int height, int channels, GLint filtering, GLint wrapping, int levels = 1)
+        {
+            GLenum internal_format, format, type;
+            texture_format(channels, internal_format, format, type);
+
+            // only the texture, not what a derived class keeps alongside it...
+            texture::free();
+            width_ = width;
+            height_ = height;
+            channels_ = channels;
+            levels_ = levels;
+
+            glGenTextures(1, &id_);
+            glBindTexture(GL_TEXTURE_2D, id_);
+            const gl& gl_fn = gl::current();
+            if (gl_fn.supports(4, 2, "GL_ARB_texture_storage"))
+                gl_fn.glTexStorage2D(GL_TEXTURE_2D, levels, internal_format, width, height);
+            else
             {
-            case 3:     // 24bit RGB (byte)
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img.width_, img.height_, 0, GL_RGB, GL_UNSIGNED_BYTE, &img.data_.front());
-                break;
-            case 4:     // 32bit RGBA (byte)
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width_, img.height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, &img.data_.front());
-                break;
-            case 12:     // 96bit RGB (float)
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img.width_, img.height_, 0, GL_RGB, GL_FLOAT, &img.data_.front());
-                break;
-            case 16:     // 128bit RGBA
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width_, img.height_, 0, GL_RGBA, GL_FLOAT, &img.data_.front());
-                break;
+                for (int level = 0; level < levels; ++level)
+                    glTexImage2D(GL_TEXTURE_2D, level, internal_format, std::max(1, width >> level), std::max(1, height >> level), 0, format, type, nullptr);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
             }
+            glBindTexture(GL_TEXTURE_2D, 0);
+            parameters(filtering, wrapping);
+        }
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filtering);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filtering);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapping);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapping);
-            glBindTexture(GL_TEXTURE_2D, NULL);
+        // replace width x height pixels at x, y (from the bottom left, as GL) with those at the start of img's rows,
+        // mips are regenerated...
+        void update(int x, int y, int width, int height, const image_view& img)
+        {
+            if (!id_)
+                throw std::runtime_error("glo::texture::update without storage.");
+            if (img.channels_ != channels_)
+                throw std::runtime_error("glo::texture::update format differs from the storage's.");
+            if (x < 0 || y < 0 || x + width > width_ || y + height > height_ || width > img.width_ || height > img.height_)
+                throw std::runtime_error("glo::texture::update region out of bounds.");
+
+            GLenum internal_format, format, type;
+            texture_format(channels_, internal_format, format, type);
+
+            // rows of 3 byte pixels (or a narrower region) aren't the 4 byte aligned rows GL assumes...
+            const bool packed = (img.width_ * img.channels_) % 4 != 0;
+            glBindTexture(GL_TEXTURE_2D, id_);
+            if (img.width_ != width)
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, img.width_);
+            if (packed)
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, img.data_);
+            if (packed)
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            if (img.width_ != width)
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            if (levels_ > 1)
+                gl::current().glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
         }
 
-        void free()
+        void update(int x, int y, const image_view& img) { update(x, y, img.width_, img.height_, img); }
+
+        int channels() const { return channels_; }
+
+        virtual void free()
         {
             if (id_)
                 glDeleteTextures(1, &id_);
@@ -113,20 +403,187 @@ namespace glo
         }
 
         GLuint ID() const { return id_; }
+
+    protected:
+        // minification through the mips when there are any...
+        void parameters(GLint filtering, GLint wrapping)
+        {
+            GLint min_filtering = filtering;
+            if (levels_ > 1)
+                min_filtering = filtering == GL_NEAREST ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+
+            glBindTexture(GL_TEXTURE_2D, id_);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filtering);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filtering);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapping);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapping);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    };
+
+    // A texture replaced every frame (e.g. video), written through a ring of pixel unpack buffers guarded by fences
+    // so the CPU fills frame N+2 while the GPU still reads frame N. Buffers are persistently mapped where
+    // ARB_buffer_storage (GL 4.4) is supported, orphaned and remapped each frame otherwise...
+    class texture_stream : public texture
+    {
+    public:
+        static constexpr int ring = 3;
+
+        texture_stream(int width, int height, int channels, GLint filtering, GLint wrapping)
+            : texture(width, height, channels, filtering, wrapping), frame_bytes_(static_cast<std::size_t>(width) * height * channels)
+        {
+            const gl& gl_fn = gl::current();
+            gl_fn.glGenBuffers(1, &buffer_);
+            gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+            if (buffer_storage())
+            {
+                const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                gl_fn.glBufferStorage(GL_PIXEL_UNPACK_BUFFER, frame_bytes_ * ring, nullptr, flags);
+                mapped_ = static_cast<unsigned char*>(gl_fn.glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frame_bytes_ * ring, flags));
+            }
+            if (!mapped_)
+                gl_fn.glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes_, nullptr, GL_STREAM_DRAW);
+            gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        // memory for the next frame (rows bottom first, as images), written until submit from any thread,
+        // map and submit on the drawing thread. Only waits if the GPU is a whole ring behind...
+        unsigned char* map()
+        {
+            if (writing_)
+                return writing_;
+            if (static_cast<std::size_t>(image_width()) * image_height() * channels() != frame_bytes_)
+                throw std::runtime_error("glo::texture_stream reallocated, the ring no longer fits it.");
+
+            const gl& gl_fn = gl::current();
+            if (mapped_)
+            {
+                if (GLsync fence = fences_[slot_])
+                {
+                    // flushed so a fence not yet sent can't be waited on forever...
+                    GLenum status = gl_fn.glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+                    if (status == GL_TIMEOUT_EXPIRED)
+                    {
+                        ++waits_;
+                        while ((status = gl_fn.glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)) == GL_TIMEOUT_EXPIRED)
+                            ;
+                    }
+                    if (status == GL_WAIT_FAILED)
+                        throw std::runtime_error("glo::texture_stream fence wait failed.");
+                    gl_fn.glDeleteSync(fence);
+                    fences_[slot_] = nullptr;
+                }
+                writing_ = mapped_ + slot_ * frame_bytes_;
+            }
+            else
+            {
+                // orphaned, the driver hands out fresh storage while the GPU reads the old...
+                gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+                gl_fn.glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes_, nullptr, GL_STREAM_DRAW);
+                writing_ = static_cast<unsigned char*>(gl_fn.glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frame_bytes_, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+                gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                if (!writing_)
+                    throw std::runtime_error("glo::texture_stream unable to map buffer.");
+            }
+            return writing_;
+        }
+
+        // the mapped frame to the texture, copied by the GPU from the buffer...
+        void submit()
+        {
+            if (!writing_)
+                throw std::runtime_error("glo::texture_stream::submit without map.");
+
+            const gl& gl_fn = gl::current();
+            gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+            std::size_t offset = 0;
+            if (mapped_)
+                offset = slot_ * frame_bytes_;
+            else
+                gl_fn.glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+            // with a buffer bound the image's data is an offset into it...
+            texture::update(0, 0, image_view(image_width(), image_height(), channels(), reinterpret_cast<const unsigned char*>(offset)));
+            gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            if (mapped_)
+            {
+                fences_[slot_] = gl_fn.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                slot_ = (slot_ + 1) % ring;
+            }
+            writing_ = nullptr;
+        }
+
+        using texture::update;
+
+        // a whole frame, copied into the ring...
+        void update(const image_view& img)
+        {
+            if (img.width_ != image_width() || img.height_ != image_height() || img.channels_ != channels())
+                throw std::runtime_error("glo::texture_stream::update size or format differs from the stream's.");
+            std::memcpy(map(), img.data_, frame_bytes_);
+            submit();
+        }
+
+        bool persistent() const { return mapped_ != nullptr; }
+
+        // frames map had to wait for the GPU, the ring is too short if this grows...
+        std::size_t waits() const { return waits_; }
+
+        void free() override
+        {
+            if (buffer_)
+            {
+                const gl& gl_fn = gl::current();
+                for (int f = 0; f < ring; ++f)
+                    if (fences_[f])
+                        gl_fn.glDeleteSync(fences_[f]);
+                if (mapped_ || writing_)
+                {
+                    gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+                    gl_fn.glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                    gl_fn.glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                }
+                gl_fn.glDeleteBuffers(1, &buffer_);
+            }
+            buffer_ = 0;
+            mapped_ = writing_ = nullptr;
+            for (int f = 0; f < ring; ++f)
+                fences_[f] = nullptr;
+            texture::free();
+        }
+
+    private:
+        // the ring is sized for the texture, it isn't reallocated...
+        using texture::cache;
+        using texture::allocate;
+
+        // GL 4.4 or the extension, the entry point alone may resolve without either...
+        static bool buffer_storage()
+        {
+            const gl& gl_fn = gl::current();
+            return gl_fn.glBufferStorage && gl_fn.glMapBufferRange && gl_fn.supports(4, 4, "GL_ARB_buffer_storage");
+        }
+
+        std::size_t frame_bytes_;
+        GLuint buffer_ = 0;
+        unsigned char* mapped_ = nullptr;       // the whole ring, persistent only
+        unsigned char* writing_ = nullptr;      // between map and submit
+        GLsync fences_[ring] = {};
+        int slot_ = 0;
+        std::size_t waits_ = 0;
     };
 
     static image image_read(const char* filename)
     {
 #ifdef GLO_USE_STB
         image result; 
-        if (unsigned char* data = stbi_load(filename, &result.width_, &result.height_, &result.channels_, 4))
+        int source_channels = 0;
+        if (unsigned char* data = stbi_load(filename, &result.width_, &result.height_, &source_channels, 4))
         {
-            result.data_ = std::vector<unsigned char>(result.width_ * result.height_ * result.channels_); 
-            for (unsigned int p = 0; p < result.data_.size(); ++p)
-                result.data_[p] = static_cast<unsigned char>(*(data + p)); 
-
-            stbi_image_free(data); 
-            image_flipv(result);
+            result.channels_ = 4;   // converted to RGBA whatever the source
+            result.adopt(data, [](unsigned char* pixels) { stbi_image_free(pixels); });
+            image_flipv(result, image_threads(result));
             return result;
         }
         throw std::runtime_error("glo::image_read unable to read image " + std::string(filename));
@@ -136,28 +593,30 @@ namespace glo
 #endif // GLO_USE_STB
     }
     
+    // an encoded image in memory (e.g. a mapped file), as image_read(filename)...
     static image image_read(const unsigned char* buffer, unsigned int size)
     {
 #ifdef GLO_USE_STB
         image result;
-        if (char* data = (char*)stbi_load_from_memory(buffer, size, &result.width_, &result.height_, &result.channels_, 4))
+        int source_channels = 0;
+        if (unsigned char* data = stbi_load_from_memory(buffer, size, &result.width_, &result.height_, &source_channels, 4))
         {
-            result.data_ = std::vector<unsigned char>(result.width_ * result.height_ * result.channels_);
-            for (unsigned int p = 0; p < result.data_.size(); ++p)
-                result.data_[p] = static_cast<unsigned char>(*(data + p));
-            stbi_image_free(data);
+            result.channels_ = 4;   // converted to RGBA whatever the source
+            result.adopt(data, [](unsigned char* pixels) { stbi_image_free(pixels); });
+            image_flipv(result, image_threads(result));
+            return result;
         }
-        return result;
+        throw std::runtime_error("glo::image_read unable to decode image from memory");
 #else
         //#warning "glo::image_read has no implementation. e.g. define GLO_USE_STB"
         throw std::runtime_error("glo::image_read has no implementation. e.g. define GLO_USE_STB");
 #endif // GLO_USE_STB
     }
     
-    static void image_write(const char* filename, const image& img)
+    static void image_write(const char* filename, const image_view& img)
     {
 #ifdef GLO_USE_STB
-        stbi_write_png(filename, img.width_, img.height_, img.channels_, &img.data_.front(), img.width_ * img.channels_);
+        stbi_write_png(filename, img.width_, img.height_, img.channels_, img.data_, img.width_ * img.channels_);
 #else
         //#warning "glo::image_read has no implementation. e.g. define GLO_USE_STB"
         throw std::runtime_error("glo::image_read has no implementation. e.g. define GLO_USE_STB");
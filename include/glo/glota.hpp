@@ -0,0 +1,487 @@
+// GLO texture atlas, many small images (icons, thumbnails) packed into a few large textures so they draw with
+// one bind. Packing (MaxRects) and pixels are kept on the CPU, textures only change in upload, so an atlas can
+// be built or compacted on a worker thread and uploaded on the drawing thread. Nothing is locked, while compacted
+// runs the source atlas may be read (get, page) but not changed (add, remove, use, upload).
+
+#ifndef GLOTA_HPP
+#define GLOTA_HPP
+
+#include "glop.hpp"
+#include "glot.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace glo
+{
+    // MaxRects packing (best short side fit) of rectangles into a fixed area, with release...
+    class rect_packer
+    {
+    public:
+        struct rect
+        {
+            int x_;
+            int y_;
+            int width_;
+            int height_;
+        };
+
+        rect_packer(int width, int height) : width_(width), height_(height)
+        {
+            free_.push_back({ 0, 0, width, height });
+        }
+
+        // false if there is no room...
+        bool insert(int width, int height, rect& placed)
+        {
+            const rect* best = nullptr;
+            int best_short = 0, best_long = 0;
+            for (auto f = free_.begin(); f != free_.end(); ++f)
+            {
+                if (f->width_ < width || f->height_ < height)
+                    continue;
+                int short_side = std::min(f->width_ - width, f->height_ - height);
+                int long_side = std::max(f->width_ - width, f->height_ - height);
+                if (!best || short_side < best_short || (short_side == best_short && long_side < best_long))
+                {
+                    best = &*f;
+                    best_short = short_side;
+                    best_long = long_side;
+                }
+            }
+            if (!best)
+                return false;
+
+            placed = { best->x_, best->y_, width, height };
+            split(placed);
+            prune();
+            used_ += static_cast<std::int64_t>(width) * height;
+            ++count_;
+            return true;
+        }
+
+        // give a placed rectangle's area back...
+        void release(const rect& placed)
+        {
+            used_ -= static_cast<std::int64_t>(placed.width_) * placed.height_;
+            if (--count_ == 0)
+            {
+                free_.assign(1, { 0, 0, width_, height_ });
+                return;
+            }
+            free_.push_back(placed);
+            merge();
+            prune();
+        }
+
+        // fraction of the area in use...
+        float occupancy() const { return static_cast<float>(used_) / (static_cast<float>(width_) * height_); }
+
+    private:
+        static bool overlaps(const rect& a, const rect& b)
+        {
+            return a.x_ < b.x_ + b.width_ && b.x_ < a.x_ + a.width_ && a.y_ < b.y_ + b.height_ && b.y_ < a.y_ + a.height_;
+        }
+
+        static bool contains(const rect& outer, const rect& inner)
+        {
+            return inner.x_ >= outer.x_ && inner.y_ >= outer.y_ && inner.x_ + inner.width_ <= outer.x_ + outer.width_ && inner.y_ + inner.height_ <= outer.y_ + outer.height_;
+        }
+
+        // free rectangles the placed one overlaps are replaced by what's left of them on each side...
+        void split(const rect& placed)
+        {
+            std::vector<rect> pieces;
+            for (auto f = free_.begin(); f != free_.end();)
+            {
+                if (!overlaps(*f, placed))
+                {
+                    ++f;
+                    continue;
+                }
+                if (placed.x_ > f->x_)
+                    pieces.push_back({ f->x_, f->y_, placed.x_ - f->x_, f->height_ });
+                if (placed.x_ + placed.width_ < f->x_ + f->width_)
+                    pieces.push_back({ placed.x_ + placed.width_, f->y_, f->x_ + f->width_ - (placed.x_ + placed.width_), f->height_ });
+                if (placed.y_ > f->y_)
+                    pieces.push_back({ f->x_, f->y_, f->width_, placed.y_ - f->y_ });
+                if (placed.y_ + placed.height_ < f->y_ + f->height_)
+                    pieces.push_back({ f->x_, placed.y_ + placed.height_, f->width_, f->y_ + f->height_ - (placed.y_ + placed.height_) });
+                f = free_.erase(f);
+            }
+            free_.insert(free_.end(), pieces.begin(), pieces.end());
+        }
+
+        // drop free rectangles inside others...
+        void prune()
+        {
+            for (std::size_t i = 0; i < free_.size(); ++i)
+                for (std::size_t j = i + 1; j < free_.size(); ++j)
+                {
+                    if (contains(free_[j], free_[i]))
+                    {
+                        free_.erase(free_.begin() + i);
+                        --i;
+                        break;
+                    }
+                    if (contains(free_[i], free_[j]))
+                    {
+                        free_.erase(free_.begin() + j);
+                        --j;
+                    }
+                }
+        }
+
+        // join free rectangles sharing a whole edge, so released space can take larger rectangles again...
+        void merge()
+        {
+            for (bool merged = true; merged;)
+            {
+                merged = false;
+                for (std::size_t i = 0; i < free_.size() && !merged; ++i)
+                    for (std::size_t j = i + 1; j < free_.size() && !merged; ++j)
+                    {
+                        rect& a = free_[i];
+                        const rect& b = free_[j];
+                        if (a.y_ == b.y_ && a.height_ == b.height_ && (a.x_ + a.width_ == b.x_ || b.x_ + b.width_ == a.x_))
+                        {
+                            a = { std::min(a.x_, b.x_), a.y_, a.width_ + b.width_, a.height_ };
+                            merged = true;
+                        }
+                        else if (a.x_ == b.x_ && a.width_ == b.width_ && (a.y_ + a.height_ == b.y_ || b.y_ + b.height_ == a.y_))
+                        {
+                            a = { a.x_, std::min(a.y_, b.y_), a.width_, a.height_ + b.height_ };
+                            merged = true;
+                        }
+                        if (merged)
+                            free_.erase(free_.begin() + j);
+                    }
+            }
+        }
+
+        int width_;
+        int height_;
+        std::vector<rect> free_;
+        std::int64_t used_ = 0;
+        std::size_t count_ = 0;
+    };
+
+    // Images packed into pages (textures) with padding, found by the handle add returns...
+    class atlas
+    {
+    public:
+        typedef std::size_t handle;
+
+        struct region
+        {
+            int page_;                  // texture(page_)
+            int x_;                     // in pixels from the bottom left, padding excluded
+            int y_;
+            int width_;
+            int height_;
+            float u0_, v0_, u1_, v1_;   // texture coordinates of the image
+        };
+
+        typedef std::function<void(handle)> evicted_fn;
+
+        // max_pages 0 for as many as needed, otherwise the least recently used images are evicted to make room...
+        atlas(int page_width = 2048, int page_height = 2048, int padding = 1, int channels = 4, int max_pages = 0)
+            : page_width_(page_width), page_height_(page_height), padding_(padding), channels_(channels), max_pages_(max_pages)
+        {
+        }
+
+        // the page textures go with the atlas (drawing thread, as upload)...
+        ~atlas() { free(); }
+
+        atlas(atlas&&) = default;
+        atlas& operator=(atlas&& other)
+        {
+            if (this == &other)
+                return *this;
+            free();
+            page_width_ = other.page_width_;
+            page_height_ = other.page_height_;
+            padding_ = other.padding_;
+            channels_ = other.channels_;
+            max_pages_ = other.max_pages_;
+            pages_ = std::move(other.pages_);
+            other.pages_.clear();
+            entries_ = std::move(other.entries_);
+            next_ = other.next_;
+            clock_ = other.clock_;
+            evicted_fn_ = std::move(other.evicted_fn_);
+            return *this;
+        }
+
+        // images for the same handles, largest first, packed and nothing uploaded (no GL, any thread)...
+        static atlas build(const std::vector<image>& images, int page_width = 2048, int page_height = 2048, int padding = 1, int channels = 4)
+        {
+            atlas result(page_width, page_height, padding, channels);
+            std::vector<handle> order(images.size());
+            for (handle h = 0; h < order.size(); ++h)
+                order[h] = h;
+            std::stable_sort(order.begin(), order.end(), [&images](handle a, handle b) { return images[a].height_ > images[b].height_; });
+            for (auto h = order.begin(); h != order.end(); ++h)
+            {
+                const image& img = images[*h];
+                result.check(img.width_, img.height_, img.channels_);
+                result.place(*h, img.width_, img.height_, img.pixels(), img.width_);
+            }
+            result.next_ = images.size();
+            return result;
+        }
+
+        // called with each handle evicted to make room...
+        void evicted(evicted_fn fn) { evicted_fn_ = fn; }
+
+        // pack and copy an image (no GL), uploaded with the next upload...
+        handle add(const image_view& img)
+        {
+            check(img.width_, img.height_, img.channels_);
+            handle h = next_++;
+            place(h, img.width_, img.height_, img.data_, img.width_);
+            return h;
+        }
+
+        void remove(handle h)
+        {
+            auto found = entries_.find(h);
+            if (found == entries_.end())
+                return;
+            pages_[found->second.region_.page_].packer_.release(found->second.placed_);
+            entries_.erase(found);
+        }
+
+        bool contains(handle h) const { return entries_.find(h) != entries_.end(); }
+
+        const region& get(handle h) const
+        {
+            auto found = entries_.find(h);
+            if (found == entries_.end())
+                throw std::runtime_error("glo::atlas no such image.");
+            return found->second.region_;
+        }
+
+        // as get, marking the image used (eviction takes the least recently used)...
+        const region& use(handle h)
+        {
+            auto found = entries_.find(h);
+            if (found == entries_.end())
+                throw std::runtime_error("glo::atlas no such image.");
+            found->second.used_ = ++clock_;
+            return found->second.region_;
+        }
+
+        // create or update the page textures with what changed (drawing thread)...
+        void upload()
+        {
+            for (auto p = pages_.begin(); p != pages_.end(); ++p)
+            {
+                if (!p->texture_)
+                {
+                    p->texture_.reset(new texture(page_width_, page_height_, channels_, GL_LINEAR, GL_CLAMP_TO_EDGE));
+                    p->texture_->update(0, 0, p->pixels_);
+                }
+                else if (p->dirty_x1_ > p->dirty_x0_)
+                {
+                    // the dirty rectangle read straight out of the page's rows...
+                    const unsigned char* first = p->pixels_.pixels() + (static_cast<std::size_t>(p->dirty_y0_) * page_width_ + p->dirty_x0_) * channels_;
+                    image_view rows(page_width_, p->dirty_y1_ - p->dirty_y0_, channels_, first);
+                    p->texture_->update(p->dirty_x0_, p->dirty_y0_, p->dirty_x1_ - p->dirty_x0_, p->dirty_y1_ - p->dirty_y0_, rows);
+                }
+                p->dirty_x0_ = p->dirty_y0_ = p->dirty_x1_ = p->dirty_y1_ = 0;
+            }
+        }
+
+        // the same images repacked into as few pages as they now need, for when evictions and removals
+        // have left gaps. Only reads this atlas (no GL), so can run on a worker while it's drawn from with get and
+        // page, but add, remove, use (it stamps the entry) and upload must wait for it. Assign the result back
+        // on the drawing thread, that frees the old pages...
+        atlas compacted() const
+        {
+            atlas result(page_width_, page_height_, padding_, channels_, max_pages_);
+            result.evicted_fn_ = evicted_fn_;
+            result.next_ = next_;
+            result.clock_ = clock_;
+
+            std::vector<std::pair<handle, const entry*>> live;
+            for (auto e = entries_.begin(); e != entries_.end(); ++e)
+                live.push_back(std::make_pair(e->first, &e->second));
+            std::stable_sort(live.begin(), live.end(), [](const std::pair<handle, const entry*>& a, const std::pair<handle, const entry*>& b)
+                {
+                    return a.second->region_.height_ > b.second->region_.height_;
+                });
+            for (auto l = live.begin(); l != live.end(); ++l)
+            {
+                const region& r = l->second->region_;
+                const unsigned char* source = pages_[r.page_].pixels_.pixels() + (static_cast<std::size_t>(r.y_) * page_width_ + r.x_) * channels_;
+                result.place(l->first, r.width_, r.height_, source, page_width_);
+                result.entries_[l->first].used_ = l->second->used_;
+            }
+            return result;
+        }
+
+        std::size_t size() const { return entries_.size(); }
+        int pages() const { return static_cast<int>(pages_.size()); }
+
+        // a page's texture, once uploaded...
+        const texture& page(int p) const
+        {
+            if (!pages_[p].texture_)
+                throw std::runtime_error("glo::atlas page not uploaded.");
+            return *pages_[p].texture_;
+        }
+
+        float occupancy(int p) const { return pages_[p].packer_.occupancy(); }
+
+        // the page textures, recreated by the next upload...
+        void free()
+        {
+            for (auto p = pages_.begin(); p != pages_.end(); ++p)
+                if (p->texture_)
+                {
+                    p->texture_->free();
+                    p->texture_.reset();
+                }
+        }
+
+    private:
+        // a page's packing and pixels, kept for updates and compaction...
+        struct sheet
+        {
+            sheet(int width, int height, int channels)
+                : packer_(width, height), pixels_(width, height, channels, std::vector<unsigned char>(static_cast<std::size_t>(width) * height * channels)) {}
+
+            void dirty(int x, int y, int width, int height)
+            {
+                if (dirty_x1_ <= dirty_x0_)
+                {
+                    dirty_x0_ = x;
+                    dirty_y0_ = y;
+                    dirty_x1_ = x + width;
+                    dirty_y1_ = y + height;
+                    return;
+                }
+                dirty_x0_ = std::min(dirty_x0_, x);
+                dirty_y0_ = std::min(dirty_y0_, y);
+                dirty_x1_ = std::max(dirty_x1_, x + width);
+                dirty_y1_ = std::max(dirty_y1_, y + height);
+            }
+
+            rect_packer packer_;
+            image pixels_;
+            std::unique_ptr<texture> texture_;
+            int dirty_x0_ = 0, dirty_y0_ = 0, dirty_x1_ = 0, dirty_y1_ = 0;
+        };
+
+        struct entry
+        {
+            region region_;
+            rect_packer::rect placed_;      // with padding
+            std::uint64_t used_;
+        };
+
+        void check(int width, int height, int channels) const
+        {
+            if (channels != channels_)
+                throw std::runtime_error("glo::atlas image channels differ from the atlas'.");
+            if (width <= 0 || height <= 0 || width + padding_ * 2 > page_width_ || height + padding_ * 2 > page_height_)
+                throw std::runtime_error("glo::atlas image larger than a page.");
+        }
+
+        // room in an existing page, a new one, or evicting the least recently used until there is...
+        void place(handle h, int width, int height, const unsigned char* pixels, int stride)
+        {
+            const int padded_width = width + padding_ * 2, padded_height = height + padding_ * 2;
+            rect_packer::rect placed;
+            int p = 0;
+            for (; p < static_cast<int>(pages_.size()); ++p)
+                if (pages_[p].packer_.insert(padded_width, padded_height, placed))
+                    break;
+
+            if (p == static_cast<int>(pages_.size()))
+            {
+                if (!max_pages_ || p < max_pages_)
+                {
+                    pages_.emplace_back(page_width_, page_height_, channels_);
+                    pages_.back().packer_.insert(padded_width, padded_height, placed);
+                }
+                else
+                {
+                    for (p = -1; p < 0;)
+                    {
+                        if (entries_.empty())
+                            throw std::runtime_error("glo::atlas image doesn't fit.");
+                        auto oldest = std::min_element(entries_.begin(), entries_.end(), [](const std::pair<const handle, entry>& a, const std::pair<const handle, entry>& b)
+                            {
+                                return a.second.used_ < b.second.used_;
+                            });
+                        handle evicted = oldest->first;
+                        int from = oldest->second.region_.page_;
+                        remove(evicted);
+                        if (evicted_fn_)
+                            evicted_fn_(evicted);
+                        if (pages_[from].packer_.insert(padded_width, padded_height, placed))
+                            p = from;
+                    }
+                }
+            }
+
+            sheet& target = pages_[p];
+            copy(target.pixels_, placed.x_ + padding_, placed.y_ + padding_, width, height, pixels, stride);
+            target.dirty(placed.x_, placed.y_, placed.width_, placed.height_);
+
+            entry& e = entries_[h];
+            e.placed_ = placed;
+            e.used_ = ++clock_;
+            e.region_ = { p, placed.x_ + padding_, placed.y_ + padding_, width, height,
+                static_cast<float>(placed.x_ + padding_) / page_width_, static_cast<float>(placed.y_ + padding_) / page_height_,
+                static_cast<float>(placed.x_ + padding_ + width) / page_width_, static_cast<float>(placed.y_ + padding_ + height) / page_height_ };
+        }
+
+        // the image into the page, its edges repeated into the padding so filtering never reads a neighbour...
+        void copy(image& target, int x, int y, int width, int height, const unsigned char* pixels, int stride)
+        {
+            const std::size_t bytes = static_cast<std::size_t>(channels_);
+            const std::size_t row = static_cast<std::size_t>(page_width_) * bytes;
+            unsigned char* base = target.pixels();
+            for (int r = 0; r < height; ++r)
+            {
+                unsigned char* to = base + (y + r) * row + x * bytes;
+                std::memcpy(to, pixels + static_cast<std::size_t>(r) * stride * bytes, width * bytes);
+                for (int p = 1; p <= padding_; ++p)
+                {
+                    std::memcpy(to - p * bytes, to, bytes);
+                    std::memcpy(to + (width - 1 + p) * bytes, to + (width - 1) * bytes, bytes);
+                }
+            }
+            const std::size_t span = (width + padding_ * 2) * bytes;
+            unsigned char* bottom = base + y * row + (x - padding_) * bytes;
+            unsigned char* top = base + (y + height - 1) * row + (x - padding_) * bytes;
+            for (int p = 1; p <= padding_; ++p)
+            {
+                std::memcpy(bottom - p * row, bottom, span);
+                std::memcpy(top + p * row, top, span);
+            }
+        }
+
+        int page_width_;
+        int page_height_;
+        int padding_;
+        int channels_;
+        int max_pages_;
+        std::vector<sheet> pages_;
+        std::map<handle, entry> entries_;
+        handle next_ = 0;
+        std::uint64_t clock_ = 0;
+        evicted_fn evicted_fn_;
+    };
+}
+
+#endif // GLOTA_HPP
@@ -0,0 +1,304 @@
+// GLO compressed textures, BC1-5/BC7 (and ETC2 where the driver supports it) read from DDS and KTX2 containers
+// and uploaded as they are (glCompressedTexSubImage2D into immutable storage) with their mip chains, no decoding.
+// Containers store rows top first, unlike images read with image_read, so flip v when sampling.
+
+#ifndef GLOTC_HPP
+#define GLOTC_HPP
+
+#include "glop.hpp"
+#include "glot.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// S3TC is an extension to desktop GL, its enums aren't in every glext.h...
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace glo
+{
+    // A block compressed image with its mips, as stored in the container...
+    struct compressed_image
+    {
+        struct level
+        {
+            std::size_t offset_;        // into data_
+            std::size_t size_;
+            int width_;
+            int height_;
+        };
+
+        int width_ = 0;
+        int height_ = 0;
+        GLenum format_ = 0;             // GL compressed internal format
+        int block_bytes_ = 0;           // per 4x4 block
+        std::vector<level> levels_;     // largest first
+        std::vector<unsigned char> data_;
+    };
+
+    // bytes per 4x4 block of a GL compressed format, 0 if not one glo knows...
+    static int compressed_block_bytes(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+        case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+            return 16;
+        }
+        return 0;
+    }
+
+    // little endian fields of a container...
+    static std::uint64_t compressed_field(const std::vector<unsigned char>& data, std::size_t offset, std::size_t bytes)
+    {
+        if (offset + bytes > data.size())
+            throw std::runtime_error("glo::compressed_read truncated file.");
+        std::uint64_t value = 0;
+        for (std::size_t b = 0; b < bytes; ++b)
+            value |= static_cast<std::uint64_t>(data[offset + b]) << (8 * b);
+        return value;
+    }
+
+    // levels laid out one after the other from offset, each checked against the data (a count past the
+    // full chain is clamped, shifting by 32 or more is undefined)...
+    static void compressed_levels(compressed_image& img, std::size_t offset, int count)
+    {
+        count = std::min(count, texture_levels(img.width_, img.height_));
+        for (int l = 0; l < count; ++l)
+        {
+            int width = std::max(1, img.width_ >> l), height = std::max(1, img.height_ >> l);
+            std::size_t size = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * img.block_bytes_;
+            if (offset > img.data_.size() || size > img.data_.size() - offset)
+                throw std::runtime_error("glo::compressed_read truncated mip chain.");
+            img.levels_.push_back({ offset, size, width, height });
+            offset += size;
+        }
+    }
+
+    static void compressed_read_dds(compressed_image& img)
+    {
+        const std::vector<unsigned char>& d = img.data_;
+        const std::size_t header = 4, pixel_header = header + 72;
+        img.height_ = static_cast<int>(compressed_field(d, header + 8, 4));
+        img.width_ = static_cast<int>(compressed_field(d, header + 12, 4));
+        int levels = static_cast<int>(compressed_field(d, header + 24, 4));
+        std::uint32_t caps2 = static_cast<std::uint32_t>(compressed_field(d, header + 108, 4));
+        if (caps2 & 0xFE00u)
+            throw std::runtime_error("glo::compressed_read cube map and volume DDS unsupported.");
+
+        std::size_t offset = header + 124;
+        char four_cc[5] = {};
+        std::memcpy(four_cc, &d[pixel_header + 8], 4);
+        const std::string cc(four_cc);
+        if (cc == "DXT1") img.format_ = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        else if (cc == "DXT3") img.format_ = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        else if (cc == "DXT5") img.format_ = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else if (cc == "ATI1" || cc == "BC4U") img.format_ = GL_COMPRESSED_RED_RGTC1;
+        else if (cc == "BC4S") img.format_ = GL_COMPRESSED_SIGNED_RED_RGTC1;
+        else if (cc == "ATI2" || cc == "BC5U") img.format_ = GL_COMPRESSED_RG_RGTC2;
+        else if (cc == "BC5S") img.format_ = GL_COMPRESSED_SIGNED_RG_RGTC2;
+        else if (cc == "DX10")
+        {
+            // the extended header names a DXGI format...
+            if (compressed_field(d, offset + 12, 4) > 1 || (compressed_field(d, offset + 8, 4) & 0x4u))
+                throw std::runtime_error("glo::compressed_read texture array and cube map DDS unsupported.");
+            switch (compressed_field(d, offset, 4))
+            {
+            case 71: img.format_ = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+            case 72: img.format_ = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
+            case 74: img.format_ = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+            case 75: img.format_ = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; break;
+            case 77: img.format_ = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+            case 78: img.format_ = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+            case 80: img.format_ = GL_COMPRESSED_RED_RGTC1; break;
+            case 81: img.format_ = GL_COMPRESSED_SIGNED_RED_RGTC1; break;
+            case 83: img.format_ = GL_COMPRESSED_RG_RGTC2; break;
+            case 84: img.format_ = GL_COMPRESSED_SIGNED_RG_RGTC2; break;
+            case 95: img.format_ = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; break;
+            case 96: img.format_ = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; break;
+            case 98: img.format_ = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+            case 99: img.format_ = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+            default: throw std::runtime_error("glo::compressed_read unsupported DXGI format.");
+            }
+            offset += 20;
+        }
+        else
+            throw std::runtime_error("glo::compressed_read unsupported DDS format " + cc + ".");
+
+        img.block_bytes_ = compressed_block_bytes(img.format_);
+        compressed_levels(img, offset, std::max(levels, 1));
+    }
+
+    static void compressed_read_ktx2(compressed_image& img)
+    {
+        const std::vector<unsigned char>& d = img.data_;
+        const std::size_t header = 12;
+        std::uint64_t vk_format = compressed_field(d, header, 4);
+        img.width_ = static_cast<int>(compressed_field(d, header + 8, 4));
+        img.height_ = static_cast<int>(compressed_field(d, header + 12, 4));
+        if (compressed_field(d, header + 16, 4) > 0 || compressed_field(d, header + 20, 4) > 1 || compressed_field(d, header + 24, 4) != 1)
+            throw std::runtime_error("glo::compressed_read only 2D KTX2 textures are supported.");
+        int levels = static_cast<int>(std::min<std::uint64_t>(compressed_field(d, header + 28, 4), texture_levels(img.width_, img.height_)));
+        levels = std::max(levels, 1);
+        if (compressed_field(d, header + 32, 4) != 0)
+            throw std::runtime_error("glo::compressed_read supercompressed (Basis, zstd) KTX2 unsupported.");
+
+        // VkFormat block formats...
+        static const GLenum formats[] = {
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,                          // 131
+            GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,
+            GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,
+            GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
+            GL_COMPRESSED_RED_RGTC1, GL_COMPRESSED_SIGNED_RED_RGTC1,
+            GL_COMPRESSED_RG_RGTC2, GL_COMPRESSED_SIGNED_RG_RGTC2,
+            GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT,
+            GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
+            GL_COMPRESSED_RGB8_ETC2, GL_COMPRESSED_SRGB8_ETC2,
+            GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+            GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC };                       // 152
+        if (vk_format < 131 || vk_format >= 131 + sizeof(formats) / sizeof(formats[0]))
+            throw std::runtime_error("glo::compressed_read unsupported KTX2 format.");
+        img.format_ = formats[vk_format - 131];
+        img.block_bytes_ = compressed_block_bytes(img.format_);
+
+        // the level index follows the 80 byte header, largest level first...
+        const std::size_t index = 80;
+        for (int l = 0; l < levels; ++l)
+        {
+            std::size_t offset = static_cast<std::size_t>(compressed_field(d, index + l * 24, 8));
+            std::size_t size = static_cast<std::size_t>(compressed_field(d, index + l * 24 + 8, 8));
+            int width = std::max(1, img.width_ >> l), height = std::max(1, img.height_ >> l);
+            std::size_t expected = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * img.block_bytes_;
+            if (size < expected || offset > d.size() || expected > d.size() - offset)
+                throw std::runtime_error("glo::compressed_read truncated mip chain.");
+            img.levels_.push_back({ offset, expected, width, height });
+        }
+    }
+
+    // a DDS or KTX2 container in memory...
+    static compressed_image compressed_read(std::vector<unsigned char> data)
+    {
+        static const unsigned char ktx2[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+        compressed_image result;
+        result.data_ = std::move(data);
+        if (result.data_.size() >= 128 && std::memcmp(&result.data_.front(), "DDS ", 4) == 0)
+            compressed_read_dds(result);
+        else if (result.data_.size() >= 80 && std::memcmp(&result.data_.front(), ktx2, sizeof(ktx2)) == 0)
+            compressed_read_ktx2(result);
+        else
+            throw std::runtime_error("glo::compressed_read not a DDS or KTX2 file.");
+        if (result.width_ <= 0 || result.height_ <= 0)
+            throw std::runtime_error("glo::compressed_read invalid size.");
+        return result;
+    }
+
+    static compressed_image compressed_read(const char* filename)
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file)
+            throw std::runtime_error("glo::compressed_read unable to read " + std::string(filename));
+        std::vector<unsigned char> data(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (!data.empty())
+            file.read(reinterpret_cast<char*>(&data.front()), static_cast<std::streamsize>(data.size()));
+        return compressed_read(std::move(data));
+    }
+
+    // A texture uploaded from a compressed image, usable anywhere a texture is...
+    class compressed_texture : public texture
+    {
+    public:
+        compressed_texture(const compressed_image& img, GLint filtering, GLint wrapping)
+            : texture(img.width_, img.height_)
+        {
+            cache(img, filtering, wrapping);
+        }
+
+        // throws if the driver doesn't take the format (e.g. ETC2 or S3TC missing)...
+        void cache(const compressed_image& img, GLint filtering, GLint wrapping)
+        {
+            if (img.levels_.empty() || !img.block_bytes_)
+                throw std::runtime_error("glo::compressed_texture empty image.");
+
+            const gl& gl_fn = gl::current();
+            const GLsizei levels = static_cast<GLsizei>(img.levels_.size());
+            while (glGetError() != GL_NO_ERROR)
+                ;
+
+            GLuint id = 0;
+            glGenTextures(1, &id);
+            glBindTexture(GL_TEXTURE_2D, id);
+            if (gl_fn.supports(4, 2, "GL_ARB_texture_storage"))
+            {
+                gl_fn.glTexStorage2D(GL_TEXTURE_2D, levels, img.format_, img.width_, img.height_);
+                for (GLsizei l = 0; l < levels; ++l)
+                {
+                    const compressed_image::level& level = img.levels_[l];
+                    gl_fn.glCompressedTexSubImage2D(GL_TEXTURE_2D, l, 0, 0, level.width_, level.height_, img.format_, static_cast<GLsizei>(level.size_), &img.data_[level.offset_]);
+                }
+            }
+            else
+            {
+                for (GLsizei l = 0; l < levels; ++l)
+                {
+                    const compressed_image::level& level = img.levels_[l];
+                    gl_fn.glCompressedTexImage2D(GL_TEXTURE_2D, l, img.format_, level.width_, level.height_, 0, static_cast<GLsizei>(level.size_), &img.data_[level.offset_]);
+                }
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+            }
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            if (glGetError() != GL_NO_ERROR)
+            {
+                glDeleteTextures(1, &id);
+                throw std::runtime_error("glo::compressed_texture format unsupported by the driver.");
+            }
+            assign(id, img.width_, img.height_, levels);
+            format_ = img.format_;
+            parameters(filtering, wrapping);
+        }
+
+        GLenum format() const { return format_; }
+
+    private:
+        GLenum format_ = 0;
+    };
+}
+
+#endif // GLOTC_HPP
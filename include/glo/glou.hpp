@@ -0,0 +1,434 @@
+// GLO upload, textures (or any GL work) created on worker threads with contexts shared with the window's,
+// so loading never stalls a frame. Create (and destroy) the uploader on the drawing thread, e.g. in init and kill.
+// drop_loader feeds dropped files through an uploader, mapped and decoded off the window's thread.
+
+#ifndef GLOU_HPP
+#define GLOU_HPP
+
+#include "glop.hpp"
+#include "glot.hpp"
+#include "glow.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef GLO_X
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // GLO_X
+
+namespace glo
+{
+    // GL work done on an upload worker, usable once its fence has signaled...
+    class upload
+    {
+    public:
+        virtual ~upload()
+        {
+            if (fence_)
+                gl::current().glDeleteSync(fence_);
+        }
+
+        // polled from the drawing thread, never blocks, rethrows a failed job...
+        bool ready()
+        {
+            if (ready_)
+                return true;
+            if (!submitted_.load(std::memory_order_acquire))
+                return false;
+            if (error_)
+                std::rethrow_exception(error_);
+
+            const gl& gl_fn = gl::current();
+            GLenum status = gl_fn.glClientWaitSync(fence_, 0, 0);
+            if (status == GL_WAIT_FAILED)
+                throw std::runtime_error("glo::upload fence wait failed.");
+            if (status == GL_TIMEOUT_EXPIRED)
+                return false;
+
+            gl_fn.glDeleteSync(fence_);
+            fence_ = nullptr;
+            ready_ = true;
+            return true;
+        }
+
+    private:
+        friend class uploader;
+
+        std::atomic<bool> submitted_{ false };
+        GLsync fence_ = nullptr;
+        std::exception_ptr error_;
+        bool ready_ = false;
+    };
+
+    // A texture created on an upload worker...
+    class texture_upload : public upload
+    {
+    public:
+        // the texture, once ready...
+        const texture& get()
+        {
+            if (!ready())
+                throw std::runtime_error("glo::texture_upload not ready.");
+            return *texture_;
+        }
+
+    private:
+        friend class uploader;
+
+        std::unique_ptr<texture> texture_;
+    };
+
+    class uploader
+    {
+    public:
+        // worker contexts shared with the current window's (call with its context current)...
+        uploader(unsigned int workers = 1)
+        {
+            glwindow::glcontext* context = glwindow_get()->context();
+            if (!context)
+                throw std::runtime_error("glo::uploader needs a window context.");
+
+            // all contexts first, nothing to join if one fails...
+            for (unsigned int w = 0; w < workers; ++w)
+            {
+                std::shared_ptr<glwindow::glcontext> shared = context->shared();
+                if (!shared)
+                    throw std::runtime_error("glo::uploader context sharing unsupported.");
+                contexts_.push_back(shared);
+            }
+            for (auto c = contexts_.begin(); c != contexts_.end(); ++c)
+            {
+                glwindow::glcontext* shared = c->get();
+                workers_.emplace_back([this, shared]() { work(*shared); });
+            }
+        }
+
+        // jobs not started are dropped...
+        ~uploader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+                jobs_.clear();
+            }
+            condition_.notify_all();
+            for (auto w = workers_.begin(); w != workers_.end(); ++w)
+                w->join();
+        }
+
+        // read (image_read) and create a texture...
+        std::shared_ptr<texture_upload> load(const std::string& filename, GLint filtering, GLint wrapping)
+        {
+            std::shared_ptr<texture_upload> result = std::make_shared<texture_upload>();
+            submit(result, [result, filename, filtering, wrapping]()
+                {
+                    image img = image_read(filename.c_str());
+                    result->texture_.reset(new texture(img, filtering, wrapping));
+                });
+            return result;
+        }
+
+        // create a texture from an image already in memory...
+        std::shared_ptr<texture_upload> load(image img, GLint filtering, GLint wrapping)
+        {
+            std::shared_ptr<texture_upload> result = std::make_shared<texture_upload>();
+            std::shared_ptr<image> source = std::make_shared<image>(std::move(img));
+            submit(result, [result, source, filtering, wrapping]()
+                {
+                    result->texture_.reset(new texture(*source, filtering, wrapping));
+                });
+            return result;
+        }
+
+        // any GL work (e.g. filling buffers), with a worker context current...
+        std::shared_ptr<upload> run(std::function<void()> fn)
+        {
+            std::shared_ptr<upload> result = std::make_shared<upload>();
+            submit(result, fn);
+            return result;
+        }
+
+    private:
+        struct job
+        {
+            std::shared_ptr<upload> result_;
+            std::function<void()> fn_;
+        };
+
+        void submit(std::shared_ptr<upload> result, std::function<void()> fn)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                jobs_.push_back({ result, fn });
+            }
+            condition_.notify_one();
+        }
+
+        void work(glwindow::glcontext& context)
+        {
+            // a worker that can't make its context current fails its jobs instead...
+            std::exception_ptr attach_error;
+            try
+            {
+                context.attach();
+            }
+            catch (...)
+            {
+                attach_error = std::current_exception();
+            }
+
+            while (true)
+            {
+                job next;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    condition_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+                    if (stop_)
+                        break;
+                    next = std::move(jobs_.front());
+                    jobs_.pop_front();
+                }
+
+                try
+                {
+                    if (attach_error)
+                        std::rethrow_exception(attach_error);
+                    next.fn_();
+
+                    // flushed so the fence reaches the GPU, the drawing thread only polls it...
+                    next.result_->fence_ = gl::current().glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                    glFlush();
+                }
+                catch (...)
+                {
+                    next.result_->error_ = std::current_exception();
+                }
+                next.result_->submitted_.store(true, std::memory_order_release);
+            }
+
+            if (!attach_error)
+                context.detach();
+        }
+
+        std::vector<std::shared_ptr<glwindow::glcontext>> contexts_;
+        std::vector<std::thread> workers_;
+        std::deque<job> jobs_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stop_ = false;
+    };
+
+    // A file mapped read only, decoded straight from the page cache without a copy...
+    class mapped_file
+    {
+    public:
+        mapped_file(const std::wstring& path)
+        {
+#ifdef GLO_WIN
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file_ == INVALID_HANDLE_VALUE)
+                throw std::runtime_error("glo::mapped_file unable to open file.");
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file_, &size) || !size.QuadPart)
+            {
+                CloseHandle(file_);
+                throw std::runtime_error("glo::mapped_file empty or unreadable file.");
+            }
+            mapping_ = CreateFileMappingW(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping_)
+                data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if (!data_)
+            {
+                if (mapping_)
+                    CloseHandle(mapping_);
+                CloseHandle(file_);
+                throw std::runtime_error("glo::mapped_file unable to map file.");
+            }
+            size_ = static_cast<std::size_t>(size.QuadPart);
+#endif // GLO_WIN
+
+#ifdef GLO_X
+            int fd = open(wide_to_utf8(path).c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::runtime_error("glo::mapped_file unable to open file.");
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size <= 0)
+            {
+                close(fd);
+                throw std::runtime_error("glo::mapped_file empty or unreadable file.");
+            }
+            // the mapping holds its own reference to the file...
+            void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED)
+                throw std::runtime_error("glo::mapped_file unable to map file.");
+            madvise(data, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+            data_ = static_cast<const unsigned char*>(data);
+            size_ = static_cast<std::size_t>(info.st_size);
+#endif // GLO_X
+        }
+
+        ~mapped_file()
+        {
+#ifdef GLO_WIN
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping_);
+            CloseHandle(file_);
+#endif // GLO_WIN
+
+#ifdef GLO_X
+            munmap(const_cast<unsigned char*>(data_), size_);
+#endif // GLO_X
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        const unsigned char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+    private:
+#ifdef GLO_WIN
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = NULL;
+#endif // GLO_WIN
+        const unsigned char* data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    // Dropped files (glwindow::drag_drop) mapped, decoded (image_read) and made textures on the uploader's workers,
+    // e.g. drag_drop([&](std::vector<std::wstring> files) { drops.add(files); }) and drops.poll() in idle.
+    // Destroy before the uploader...
+    class drop_loader
+    {
+    public:
+        struct dropped
+        {
+            std::wstring path_;
+            std::shared_ptr<texture> texture_;      // empty if the file failed
+            std::string error_;
+        };
+
+        typedef std::function<void(const dropped&)> loaded_fn;
+        typedef std::function<void(std::size_t done, std::size_t total)> progress_fn;
+
+        drop_loader(uploader& workers, GLint filtering = GL_LINEAR, GLint wrapping = GL_CLAMP_TO_EDGE)
+            : uploader_(workers), filtering_(filtering), wrapping_(wrapping), cancelled_(std::make_shared<std::atomic<bool>>(false))
+        {
+        }
+
+        // called from poll, i.e. on the drawing thread...
+        void loaded(loaded_fn fn) { loaded_fn_ = fn; }
+        void progress(progress_fn fn) { progress_fn_ = fn; }
+
+        // queue the files and return, nothing is read here...
+        void add(const std::vector<std::wstring>& files)
+        {
+            GLint filtering = filtering_, wrapping = wrapping_;
+            std::shared_ptr<std::atomic<bool>> cancelled = cancelled_;
+            for (auto file = files.begin(); file != files.end(); ++file)
+            {
+                std::shared_ptr<entry> next = std::make_shared<entry>();
+                next->result_.path_ = *file;
+                next->upload_ = uploader_.run([next, cancelled, filtering, wrapping]()
+                    {
+                        if (cancelled->load(std::memory_order_relaxed))
+                            throw std::runtime_error("glo::drop_loader cancelled.");
+
+                        image img;
+                        {
+                            mapped_file source(next->result_.path_);
+                            if (source.size() > 0xFFFFFFFFu)
+                                throw std::runtime_error("glo::drop_loader file too large.");
+                            img = image_read(source.data(), static_cast<unsigned int>(source.size()));
+                        }
+                        next->result_.texture_ = std::make_shared<texture>(img, filtering, wrapping);
+                    });
+                pending_.push_back(next);
+            }
+            total_ += files.size();
+        }
+
+        // hand over finished files (in completion order) on the drawing thread, never blocks...
+        void poll()
+        {
+            std::size_t finished = 0;
+            for (auto p = pending_.begin(); p != pending_.end();)
+            {
+                entry& e = **p;
+                try
+                {
+                    if (!e.upload_->ready())
+                    {
+                        ++p;
+                        continue;
+                    }
+                }
+                catch (const std::exception& ex)
+                {
+                    e.result_.texture_.reset();
+                    e.result_.error_ = ex.what();
+                }
+
+                std::shared_ptr<entry> done = *p;
+                p = pending_.erase(p);
+                ++done_;
+                ++finished;
+                if (loaded_fn_)
+                    loaded_fn_(done->result_);
+            }
+
+            if (finished && progress_fn_)
+                progress_fn_(done_, total_);
+
+            // a batch is over once nothing is pending, the next drop counts from zero...
+            if (pending_.empty())
+                done_ = total_ = 0;
+        }
+
+        // files queued or in flight...
+        bool busy() const { return !pending_.empty(); }
+        std::size_t done() const { return done_; }
+        std::size_t total() const { return total_; }
+
+        // drop everything pending, jobs already running finish and are discarded...
+        void cancel()
+        {
+            cancelled_->store(true, std::memory_order_relaxed);
+            cancelled_ = std::make_shared<std::atomic<bool>>(false);
+            pending_.clear();
+            done_ = total_ = 0;
+        }
+
+    private:
+        struct entry
+        {
+            dropped result_;
+            std::shared_ptr<upload> upload_;
+        };
+
+        uploader& uploader_;
+        GLint filtering_;
+        GLint wrapping_;
+        std::shared_ptr<std::atomic<bool>> cancelled_;
+        std::deque<std::shared_ptr<entry>> pending_;
+        std::size_t done_ = 0;
+        std::size_t total_ = 0;
+        loaded_fn loaded_fn_;
+        progress_fn progress_fn_;
+    };
+}
+
+#endif // GLOU_HPP
@@ -2,12 +2,26 @@
 #define GLOW_HPP
 
 #include "glop.hpp"
+#include "gloprof.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <istream>
 #include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
 #include <string>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 //// --- Windows Platform ---
@@ -53,6 +67,7 @@ void glwindow_init_impl();
 extern int glwindow_version_major();
 extern int glwindow_version_minor();
 class glwindow; extern glwindow* glwindow_get();
+static void glwindow_open_impl(std::shared_ptr<glwindow> window);
 
 //// MS Windows Platform specific...
 //#ifdef GLO_WIN
@@ -62,15 +77,20 @@ class glwindow; extern glwindow* glwindow_get();
 //#endif
 
 // Window creation macros...
-#define GLWINDOW_CLASS(major, minor, glwindow_derived) GLWINDOW_IMPL \
+#define GLWINDOW_CLASS_IMPL(impl, major, minor, glwindow_derived) impl \
 int glwindow_version_major() { return major; } \
 int glwindow_version_minor() { return minor; } \
 namespace { static std::unique_ptr<glwindow_derived> instance_; } \
-glwindow* glwindow_get() { if (!instance_) { instance_ = std::make_unique<glwindow_derived>(); } return instance_.get(); } \
+glwindow* glwindow_get() { if (glwindow* current = glwindow::current()) { return current; } if (!instance_) { instance_ = std::make_unique<glwindow_derived>(); } return instance_.get(); } \
 void glwindow_init_impl()
 
+#define GLWINDOW_CLASS(major, minor, glwindow_derived) GLWINDOW_CLASS_IMPL(GLWINDOW_IMPL, major, minor, glwindow_derived)
 #define GLWINDOW(major, minor) GLWINDOW_CLASS(major, minor, glwindow)
 
+// Headless (no window, renders into a frame buffer) creation macros, requires GLO_USE_EGL...
+#define GLWINDOW_HEADLESS_CLASS(major, minor, glwindow_derived) GLWINDOW_CLASS_IMPL(GLWINDOW_HEADLESS_IMPL, major, minor, glwindow_derived)
+#define GLWINDOW_HEADLESS(major, minor) GLWINDOW_HEADLESS_CLASS(major, minor, glwindow)
+
 // Window function macros...
 #define GLWINDOW_KILL void glwindow_kill_impl(); struct glwindow_kill_wrapper { glwindow_kill_wrapper() { \
         glwindow_get()->kill([]() { glwindow_kill_impl(); }); \
@@ -93,29 +113,67 @@ void glwindow_init_impl()
 } }; glwindow_mouse_move_wrapper glwindow_mouse_move_wrapper_; void glwindow_mouse_move_impl(int x, int y)
 
 #define GLWINDOW_MOUSE_DOWN(x, y, button) void glwindow_mouse_down_impl(int, int, glwindow::mouse_button); struct glwindow_mouse_down_wrapper { glwindow_mouse_down_wrapper() { \
-        glwindow_get()->mouse_down([](int glw_md_x, int glw_md_y, glwindow::mouse_button glw_md_b) { glwindow_mouse_down_impl(glw_md_x, glw_md_x, glw_md_b); }); \
+        glwindow_get()->mouse_down([](int glw_md_x, int glw_md_y, glwindow::mouse_button glw_md_b) { glwindow_mouse_down_impl(glw_md_x, glw_md_y, glw_md_b); }); \
 } }; glwindow_mouse_down_wrapper glwindow_mouse_down_wrapper_; void glwindow_mouse_down_impl(int x, int y, glwindow::mouse_button button)
 
 #define GLWINDOW_MOUSE_UP(x, y, button) void glwindow_mouse_up_impl(int, int, glwindow::mouse_button); struct glwindow_mouse_up_wrapper { glwindow_mouse_up_wrapper() { \
-        glwindow_get()->mouse_up([](int glw_mu_x, int glw_mu_y, glwindow::mouse_button glw_mu_b) { glwindow_mouse_up_impl(glw_mu_x, glw_mu_x, glw_mu_b); }); \
+        glwindow_get()->mouse_up([](int glw_mu_x, int glw_mu_y, glwindow::mouse_button glw_mu_b) { glwindow_mouse_up_impl(glw_mu_x, glw_mu_y, glw_mu_b); }); \
 } }; glwindow_mouse_up_wrapper glwindow_mouse_up_wrapper_; void glwindow_mouse_up_impl(int x, int y, glwindow::mouse_button button)
 
 #define GLWINDOW_MOUSE_CLICK(x, y, button) void glwindow_mouse_click_impl(int, int, glwindow::mouse_button); struct glwindow_mouse_click_wrapper { glwindow_mouse_click_wrapper() { \
-        glwindow_get()->mouse_click([](int glw_mc_x, int glw_mc_y, glwindow::mouse_button glw_mc_b) { glwindow_mouse_click_impl(glw_mc_x, glw_mc_x, glw_mc_b); }); \
+        glwindow_get()->mouse_click([](int glw_mc_x, int glw_mc_y, glwindow::mouse_button glw_mc_b) { glwindow_mouse_click_impl(glw_mc_x, glw_mc_y, glw_mc_b); }); \
 } }; glwindow_mouse_click_wrapper glwindow_mouse_click_wrapper_; void glwindow_mouse_click_impl(int x, int y, glwindow::mouse_button button)
 
 #define GLWINDOW_MOUSE_SCROLL(x, y, value) void glwindow_mouse_scroll_impl(int, int, int); struct glwindow_mouse_scroll_wrapper { glwindow_mouse_scroll_wrapper() { \
-        glwindow_get()->mouse_scroll([](int glw_ms_x, int glw_ms_y, int glw_ms_v) { glwindow_mouse_scroll_impl(glw_ms_x, glw_ms_x, glw_ms_v); }); \
+        glwindow_get()->mouse_scroll([](int glw_ms_x, int glw_ms_y, int glw_ms_v) { glwindow_mouse_scroll_impl(glw_ms_x, glw_ms_y, glw_ms_v); }); \
 } }; glwindow_mouse_scroll_wrapper glwindow_mouse_scroll_wrapper_; void glwindow_mouse_scroll_impl(int x, int y, int value)
 
 #define GLWINDOW_KEY_DOWN(x, y, key) void glwindow_key_down_impl(int, int, int); struct glwindow_key_down_wrapper { glwindow_key_down_wrapper() { \
-        glwindow_get()->key_down([](int glw_kd_x, int glw_kd_y, int glw_kd_k) { glwindow_key_down_impl(glw_kd_x, glw_kd_x, glw_kd_k); }); \
+        glwindow_get()->key_down([](int glw_kd_x, int glw_kd_y, int glw_kd_k) { glwindow_key_down_impl(glw_kd_x, glw_kd_y, glw_kd_k); }); \
 } }; glwindow_key_down_wrapper glwindow_key_down_wrapper_; void glwindow_key_down_impl(int x, int y, int key)
 
 #define GLWINDOW_KEY_UP(x, y, key) void glwindow_key_up_impl(int, int, int); struct glwindow_key_up_wrapper { glwindow_key_up_wrapper() { \
-        glwindow_get()->key_up([](int glw_ku_x, int glw_ku_y, int glw_ku_k) { glwindow_key_up_impl(glw_ku_x, glw_ku_x, glw_ku_k); }); \
+        glwindow_get()->key_up([](int glw_ku_x, int glw_ku_y, int glw_ku_k) { glwindow_key_up_impl(glw_ku_x, glw_ku_y, glw_ku_k); }); \
 } }; glwindow_key_up_wrapper glwindow_key_up_wrapper_; void glwindow_key_up_impl(int x, int y, int key)
 
+namespace glo
+{
+    // Lock-free single producer (window thread), single consumer (render thread) ring...
+    template <typename T, std::size_t capacity>
+    class spsc_queue
+    {
+    public:
+        // false if full, value is only moved from on success...
+        bool push(T& value)
+        {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            std::size_t next = (tail + 1) % capacity;
+            if (next == head_.load(std::memory_order_acquire))
+                return false;
+            ring_[tail] = std::move(value);
+            tail_.store(next, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T& value)
+        {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire))
+                return false;
+            value = std::move(ring_[head]);
+            head_.store((head + 1) % capacity, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    private:
+        std::array<T, capacity> ring_;
+        alignas(64) std::atomic<std::size_t> head_{ 0 };
+        alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    };
+}
+
 class glwindow
 {
 public:
@@ -136,20 +194,124 @@ public:
     {
     }
 
+    virtual ~glwindow()
+    {
+        // the backend stops the render thread (calling kill) before this, the derived handlers are gone by now so only join...
+        render_kill_ = false;
+        render_thread_stop();
+        if (!stats_csv_.empty())
+            stats_.csv(stats_csv_);
+    }
+
+    struct event;
+
     static const glwindow_str& title() { return glwindow_get()->window_title_; }
     static bool fullscreen() { return glwindow_get()->fullscreen_; }
     static int height() { return glwindow_get()->window_height_; }
     static int width() { return glwindow_get()->window_width_; }
     static int target_fps() { return glwindow_get()->target_fps_; }
     static int click_duration() { return glwindow_get()->click_duration_; }
+    static int swap_interval() { return glwindow_get()->swap_interval_; }
+    static int update_rate() { return glwindow_get()->update_rate_; }
+    static bool render_thread() { return glwindow_get()->render_thread_; }
+    static bool coalesce() { return glwindow_get()->coalesce_; }
+    static std::chrono::nanoseconds timestep() { return glwindow_get()->timestep_; }
+    static float interpolation() { return glwindow_get()->interpolation_; }
+    static std::chrono::nanoseconds frame_time() { return glwindow_get()->pacer_.frame_time(); }
+    static std::chrono::nanoseconds frame_jitter() { return glwindow_get()->pacer_.jitter(); }
+    static const std::string& stats_csv() { return glwindow_get()->stats_csv_; }
 
     static void title(const glwindow_str& title) { glwindow_get()->window_title_ = title; }
     static void fullscreen(bool fs) { glwindow_get()->fullscreen_ = fs; }
     static void height(int height) { glwindow_get()->window_height_ = height; }
     static void width(int width) { glwindow_get()->window_width_ = width; }
-    static void target_fps(int fps) { glwindow_get()->target_fps_ = fps; }
+    static void target_fps(int fps) { glwindow_get()->window_target_fps(fps); }
     static void click_duration(int duration) { glwindow_get()->click_duration_ = duration; }
 
+    // 0 = no vsync (lowest latency, paced by target_fps), 1+ = wait for n vblanks, -1 = adaptive (late frames tear rather than wait, 1 if unsupported)...
+    static void swap_interval(int interval) { glwindow_get()->window_swap_interval(interval); }
+
+    // startup phases of the process, time from entering main, ending with the first frame presented...
+    struct startup_phase
+    {
+        std::string name_;
+        std::chrono::nanoseconds time_;
+    };
+    static std::vector<startup_phase> startup_profile()
+    {
+        std::vector<startup_phase> phases = startup_phases();
+        glwindow* main = nullptr;
+        {
+            current_scope scope(nullptr);
+            main = glwindow_get();
+        }
+        if (main->stats_.first_frame() != std::chrono::steady_clock::time_point() && !phases.empty())
+            phases.push_back({ "first frame", std::chrono::duration_cast<std::chrono::nanoseconds>(main->stats_.first_frame() - startup_origin()) });
+        return phases;
+    }
+
+    // mark a phase (the backends mark theirs, the app can add its own e.g. "assets")...
+    static void startup_mark(const std::string& phase)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (startup_phases().empty())
+            startup_origin() = now;
+        startup_phases().push_back({ phase, std::chrono::duration_cast<std::chrono::nanoseconds>(now - startup_origin()) });
+    }
+
+    // write the frame statistics (see stats()) to a csv file when the window is destroyed, empty for none...
+    static void stats_csv(const std::string& filename) { glwindow_get()->stats_csv_ = filename; }
+
+    // fixed timestep, idle called update_rate times a second (catching up if draw is slow), 0 = once per pass...
+    static void update_rate(int rate) { glwindow_get()->window_update_rate(rate); }
+
+    // draw (and idle) on a dedicated thread with the context current there, window events are handed over at frame start (set before the window is shown)...
+    static void render_thread(bool enable) { glwindow_get()->render_thread_ = enable; }
+
+    // open another window, its context shares textures, buffers and programs with this one (call from init or later)...
+    static void open(std::shared_ptr<glwindow> window) { glwindow_open_impl(window); }
+
+    // the window the backend is handling on this thread, glwindow_get() (and so all the statics) resolve to it, the main window if null...
+    static glwindow* current() { return current_window(); }
+
+    class current_scope
+    {
+    public:
+        current_scope(glwindow* window) : previous_(current_window()) { current_window() = window; }
+        ~current_scope() { current_window() = previous_; }
+    private:
+        glwindow* previous_;
+    };
+
+    // collapse mouse moves and resizes into the latest one per frame (on by default)...
+    static void coalesce(bool enable) { glwindow_get()->coalesce_ = enable; }
+
+    // keep every mouse move and resize collapsed into the last frame, see coalesced_events...
+    static void coalesce_history(bool enable) { glwindow_get()->coalesce_history_ = enable; }
+
+    // every mouse move and resize received for this frame, oldest first (the last is the one delivered)...
+    static const std::vector<event>& coalesced_events() { return glwindow_get()->history_frame_; }
+
+    // record every delivered event (with its time and frame) to a binary file, empty to stop (call from init or a handler)...
+    static void record(const std::string& filename) { glwindow_get()->window_record(filename); }
+    static bool recording() { return glwindow_get()->record_file_.is_open(); }
+
+    // replay a recording through the same handlers, live input (other than resizes) is ignored until it ends,
+    // speed scales the original pace (2 = twice as fast), 0 delivers each event on the same frame it was recorded...
+    static void replay(const std::string& filename, double speed = 1.0) { glwindow_get()->window_replay(filename, speed); }
+    static bool replaying() { return glwindow_get()->replaying_; }
+
+    // draw only when something changed, after invalidate(), input, a resize or an expose, and not at all while minimized
+    // or covered, the loop sleeps in between (idle only runs when woken), target_fps still caps the rate...
+    static void redraw_on_demand(bool enable) { glwindow_get()->on_demand_ = enable; }
+    static bool redraw_on_demand() { return glwindow_get()->on_demand_; }
+
+    // ask for a draw in on demand mode (callable from any thread)...
+    static void invalidate() { glwindow_get()->window_invalidate(); }
+
+    // false while minimized or fully covered, as far as the platform tells...
+    static bool visible() { return glwindow_get()->visible_; }
+
     enum mouse_button
     {
         none = 0,
@@ -206,404 +368,2924 @@ public:
     void drag_drop(drag_drop_fn fn) { drag_drop_fn_ = fn; }
     virtual void drag_drop(std::vector<std::wstring> files) { drag_drop_fn_ ? drag_drop_fn_(files) : (void)0; }
 
-    class glcontext {};
+    class glcontext
+    {
+    public:
+        virtual ~glcontext() {}
+
+        // GL entry points of this context...
+        const glo::gl& dispatch() const { return dispatch_; }
+
+        // vsync, false if the context has no control over it...
+        virtual bool swap_interval(int) { return false; }
+
+        // a context sharing this one's textures, buffers and programs, for another thread (null if unsupported)...
+        virtual std::shared_ptr<glcontext> shared() { return nullptr; }
+
+        // make a shared context current on (or release it from) the calling thread...
+        virtual void attach() {}
+        virtual void detach() {}
+
+    protected:
+        glo::gl dispatch_ = {};
+    };
     void context(std::shared_ptr<glcontext> ctxt)
     {
         context_ = ctxt;
     }
     glcontext* context() { return context_.get(); }
 
-    // mouse click handler...
-    void click_begin(mouse_button button)
+    // A window event, as delivered by the backends...
+    struct event
     {
-        mouse_time_stamp_ = std::chrono::steady_clock::now();
-        mouse_button_ = button;
-    }
-    bool is_click(mouse_button button) const { return (button == mouse_button_ && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mouse_time_stamp_).count() < glwindow_get()->click_duration_); }
-    bool frame_limiter()
+        enum class event_type { mouse_move, mouse_down, mouse_up, mouse_click, mouse_scroll, key_down, key_up, resize, drag_drop };
+
+        event() {}
+        event(event_type type, int x, int y, int value = 0) : type_(type), x_(x), y_(y), value_(value), time_(std::chrono::steady_clock::now()) {}
+        event(const std::vector<std::wstring>& files) : type_(event_type::drag_drop), files_(files), time_(std::chrono::steady_clock::now()) {}
+
+        event_type type_ = event_type::mouse_move;
+        int x_ = 0;         // width for resize
+        int y_ = 0;         // height for resize
+        int value_ = 0;     // button, key or scroll delta
+        std::vector<std::wstring> files_;
+        std::chrono::steady_clock::time_point time_;    // received by the backend
+    };
+
+    // call the handler for an event...
+    virtual void dispatch(const event& e)
     {
-        if (target_fps_)
+        switch (e.type_)
         {
-            auto fps_now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::milliseconds>(fps_now - fps_time_stamp_).count() > (1000 / target_fps_))
-            {
-                fps_time_stamp_ = fps_now;
-                return true;
-            }
-            return false;
+        case event::event_type::mouse_move: mouse_move(e.x_, e.y_); break;
+        case event::event_type::mouse_down: mouse_down(e.x_, e.y_, static_cast<mouse_button>(e.value_)); break;
+        case event::event_type::mouse_up: mouse_up(e.x_, e.y_, static_cast<mouse_button>(e.value_)); break;
+        case event::event_type::mouse_click: mouse_click(e.x_, e.y_, static_cast<mouse_button>(e.value_)); break;
+        case event::event_type::mouse_scroll: mouse_scroll(e.x_, e.y_, e.value_); break;
+        case event::event_type::key_down: key_down(e.x_, e.y_, static_cast<unsigned int>(e.value_)); break;
+        case event::event_type::key_up: key_up(e.x_, e.y_, static_cast<unsigned int>(e.value_)); break;
+        case event::event_type::resize: resize(e.x_, e.y_); break;
+        case event::event_type::drag_drop: drag_drop(e.files_); break;
         }
-        return true;
     }
-protected:
-
-    const glwindow_str& window_title() const { return window_title_; }
-    bool window_fullscreen() const { return fullscreen_; }
-    int window_height() const { return window_height_; }
-    int window_width() const { return window_width_; }
-    int window_target_fps() const { return target_fps_; }
-    int window_click_duration() const { return click_duration_; }
-
-    void window_title(const glwindow_str& title) { window_title_ = title; }
-    void window_fullscreen(bool fs) { fullscreen_ = fs; }
-    void window_height(int height) { window_height_ = height; }
-    void window_width(int width) { window_width_ = width; }
-    void window_target_fps(int fps) { target_fps_ = fps; }
-    void window_click_duration(int duration) { click_duration_ = duration; }
-
-private:
-    idle_fn idle_fn_ = nullptr;
-    draw_fn draw_fn_ = nullptr;
-    kill_fn kill_fn_ = nullptr;
-    resize_fn resize_fn_ = nullptr;
-    mouse_move_fn mouse_move_fn_ = nullptr;
-    mouse_up_fn mouse_up_fn_ = nullptr;
-    mouse_click_fn mouse_click_fn_ = nullptr;
-    mouse_down_fn mouse_down_fn_ = nullptr;
-    mouse_scroll_fn mouse_scroll_fn_ = nullptr;
-    key_up_fn key_up_fn_ = nullptr;
-    key_down_fn key_down_fn_ = nullptr;
-    drag_drop_fn drag_drop_fn_ = nullptr;
 
-    glwindow_str window_title_ = L"glwindow";
-    int window_width_ = 800;
-    int window_height_ = 600;
-    bool fullscreen_ = false;
-    int target_fps_ = 60;
-    int click_duration_ = 200;
-
-    // mouse click handler...
-    std::chrono::steady_clock::time_point mouse_time_stamp_ = std::chrono::steady_clock::now();
-    std::chrono::steady_clock::time_point fps_time_stamp_ = std::chrono::steady_clock::now();
-    mouse_button mouse_button_ = mouse_button::none;
-
-    std::shared_ptr<glcontext> context_;
-};
-
-
-// Windows platform implementation...
-#ifdef GLO_WIN
-
-static HWND hWnd_;
-static HGLRC hGLrc_;
-static HINSTANCE hInst_;
-static WNDCLASSEX wcex_;
-constexpr unsigned int IDT_FRAME_TIMER = 1;
-
-// The contexts...
-class glcontext_base : public glwindow::glcontext
-{
-public:
-    glcontext_base(void* hdc)
+    // deliver an event from the window thread, handled now or handed to the render thread...
+    void post(event e)
     {
-        if (!hdc)
-            throw std::runtime_error("No device context.");
-
-        HDC hDC = static_cast<HDC>(hdc);
-        if (!hDC)
-            throw std::runtime_error("Unable to get handle device context.");
-
-        // we then need to get a valid DC...
-        PIXELFORMATDESCRIPTOR pfd;
-        memset(&pfd, 0, sizeof(PIXELFORMATDESCRIPTOR));
-        pfd.nSize = sizeof(PIXELFORMATDESCRIPTOR);
-        pfd.nVersion = 1;
-        pfd.dwFlags = PFD_DOUBLEBUFFER | PFD_SUPPORT_OPENGL | PFD_DRAW_TO_WINDOW;
-        pfd.iPixelType = PFD_TYPE_RGBA;
-        pfd.cColorBits = 32;
-        pfd.cDepthBits = 32;
-        pfd.cStencilBits = 8;
-        pfd.iLayerType = PFD_MAIN_PLANE;
-
-        int nPixelFormat = ChoosePixelFormat(hDC, &pfd);
+        // the window thread needs the size straight away (y flips)...
+        if (e.type_ == event::event_type::resize)
+        {
+            window_width_ = e.x_;
+            window_height_ = e.y_;
+        }
 
-        if (nPixelFormat == 0)
-            throw std::runtime_error("Unable to choose pixel format.");
+        if (!rendering_)
+        {
+            deliver(e);
+            return;
+        }
+        while (!events_->push(e))
+            std::this_thread::yield();
+        render_wake();
+    }
 
-        if (!SetPixelFormat(hDC, nPixelFormat, &pfd))
-            throw std::runtime_error("Unable to set pixel format.");
+    // hold back a mouse move or resize until the frame starts (or another event needs it in order)...
+    void deliver(const event& e)
+    {
+        bool move = e.type_ == event::event_type::mouse_move;
+        bool resize = e.type_ == event::event_type::resize;
+        if (replaying_ && !resize)
+            return;
+        latency_.input(e.time_);
+        if (!coalesce_ || !(move || resize))
+        {
+            deliver_pending();
+            handle(e);
+            return;
+        }
 
-        hGLrc_ = wglCreateContext(hDC);
-        wglMakeCurrent(hDC, hGLrc_);
+        if (coalesce_history_)
+            history_.push_back(e);
+        (move ? pending_move_ : pending_resize_) = e;
+        (move ? move_pending_ : resize_pending_) = true;
     }
 
-    void free(void* hdc) { wglDeleteContext(hGLrc_); }
-    void make_current(void* hdc) { wglMakeCurrent(static_cast<HDC>(hdc), hGLrc_); }
-};
-
-class glcontext_extended : public glcontext_base
-{
-public:
-    glcontext_extended(void* hdc, int major_version, int minor_version) : glcontext_base(hdc)
+    // deliver the held back resize and mouse move, without starting a new frame...
+    void deliver_pending()
     {
-        int attribs[] =
+        if (resize_pending_)
         {
-            WGL_CONTEXT_MAJOR_VERSION_ARB, major_version,
-            WGL_CONTEXT_MINOR_VERSION_ARB, minor_version,
-            WGL_CONTEXT_FLAGS_ARB, 0,
-            0
-        };
-
-        PFNWGLCREATECONTEXTATTRIBSARBPROC glwindow_context_extended_wglCreateContextAttribsARB = (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
-        if (glwindow_context_extended_wglCreateContextAttribsARB)
+            resize_pending_ = false;
+            handle(pending_resize_);
+        }
+        if (move_pending_)
         {
-            HDC hDC = static_cast<HDC>(hdc);
-            if (!hDC)
-                throw std::runtime_error("Unable to get handle device context.");
-
-            auto tmpContext = hGLrc_;
-            hGLrc_ = glwindow_context_extended_wglCreateContextAttribsARB(hDC, 0, attribs);
-            wglMakeCurrent(NULL, NULL);
-            wglDeleteContext(tmpContext);
-            if (!wglMakeCurrent(hDC, hGLrc_))
-                throw std::runtime_error("Unable to make current.");
+            move_pending_ = false;
+            handle(pending_move_);
         }
     }
-};
 
-// windows main callback...
-static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
-{
-    switch (message)
-    {
-    case WM_DESTROY:
-    {
-        KillTimer(hWnd, IDT_FRAME_TIMER);
-        glwindow_get()->kill();
-        PostQuitMessage(0);
-        break;
-    }
-    case WM_ERASEBKGND:
-        return 1;
-    case WM_PAINT:
+    // frame start, deliver what was coalesced since the last frame...
+    void deliver_frame()
     {
-        // Frame limiter...
-        //if (glwindow_get()->frame_limiter())
+        deliver_pending();
+        history_frame_.swap(history_);
+        history_.clear();
+
+        if (replaying_)
+            replay_frame();
+        if (record_file_.is_open())
         {
-            PAINTSTRUCT ps;
-            BeginPaint(hWnd, &ps);
-            glwindow_get()->draw();
-            SwapBuffers(GetDC(hWnd));
-            EndPaint(hWnd, &ps);
+            record_clock();
+            ++record_frame_;
         }
-        break;
-    }
-    case WM_SIZE:
-    {
-        glwindow_get()->resize(static_cast<int>(LOWORD(lParam)), static_cast<int>(HIWORD(lParam)));
-        glwindow_get()->height(static_cast<int>(HIWORD(lParam)));
-        glwindow_get()->width(static_cast<int>(LOWORD(lParam)));
-        break;
-    }
-    case WM_MOUSEWHEEL:
-    {
-        POINT pt; pt.x = LOWORD(lParam); pt.y = HIWORD(lParam); ScreenToClient(hWnd_, &pt);
-        glwindow_get()->mouse_scroll(pt.x, pt.y, GET_WHEEL_DELTA_WPARAM(wParam));
-        break;
-    }
-    case WM_MOUSEMOVE:
-    {
-        glwindow_get()->mouse_move(LOWORD(lParam), HIWORD(lParam));
-        break;
-    }
-    case WM_LBUTTONDOWN:
-    {
-        glwindow_get()->click_begin(glwindow::mouse_button::left);
-        glwindow_get()->mouse_down(LOWORD(lParam), glwindow_get()->height() - HIWORD(lParam), glwindow::mouse_button::left);
-        SetCapture(hWnd);
-        break;
-    }
-    case WM_LBUTTONUP:
-    {
-        int x = LOWORD(lParam);
-        int y = HIWORD(lParam);
-        if (glwindow_get()->is_click(glwindow::mouse_button::left))
-            glwindow_get()->mouse_click(x, glwindow_get()->height() - y, glwindow::mouse_button::left);
-        glwindow_get()->mouse_up(x, glwindow_get()->height() - y, glwindow::mouse_button::left);
-        ReleaseCapture();
-        break;
     }
-    case WM_MBUTTONDOWN:
+
+    // ask for a draw (e.g. expose) when drawing on the render thread or on demand...
+    void post_redraw() { redraw_ = true; render_wake(); }
+
+    // a draw was asked for, cleared (before drawing, so one asked for while drawing isn't lost)...
+    bool redraw_pending() const { return redraw_; }
+    bool take_redraw() { return redraw_.exchange(false); }
+
+    // the backend's way of waking its loop from another thread, and what it knows of visibility...
+    void waker(std::function<void()> fn) { wake_fn_ = fn; }
+    void window_visible(bool visible) { visible_ = visible; render_wake(); }
+    bool window_visible() const { return visible_; }
+    bool window_on_demand() const { return on_demand_; }
+
+    void window_invalidate()
     {
-        glwindow_get()->click_begin(glwindow::mouse_button::middle);
-        glwindow_get()->mouse_down(LOWORD(lParam), glwindow_get()->height() - HIWORD(lParam), glwindow::mouse_button::middle);
-        SetCapture(hWnd);
-        break;
+        redraw_ = true;
+        render_wake();
+        if (wake_fn_)
+            wake_fn_();
     }
-    case WM_MBUTTONUP:
+
+    // start drawing on the render thread, the context should not be current on the calling thread...
+    void render_thread_start(std::function<void()> make_current, std::function<void()> present, std::function<void()> release, std::function<void()> quit)
     {
-        int x = LOWORD(lParam);
-        int y = HIWORD(lParam);
-        if (glwindow_get()->is_click(glwindow::mouse_button::middle))
-            glwindow_get()->mouse_click(x, glwindow_get()->height() - y, glwindow::mouse_button::middle);
-        glwindow_get()->mouse_up(x, glwindow_get()->height() - y, glwindow::mouse_button::middle);
-        ReleaseCapture();
-        break;
+        if (!events_)
+            events_.reset(new glo::spsc_queue<event, 4096>());
+        rendering_ = true;
+        render_thread_handle_ = std::thread([=]()
+            {
+                // glwindow_get() on this thread is always this window, whatever the window thread is handling...
+                current_scope scope(this);
+                try
+                {
+                    make_current();
+                    while (rendering_)
+                    {
+                        // input sampled as late as possible, at frame start...
+                        {
+                            frame_stats::section section(stats_, frame_stats::phase::events);
+                            event e;
+                            while (events_->pop(e))
+                                deliver(e);
+                            deliver_frame();
+                        }
+
+                        {
+                            frame_stats::section section(stats_, frame_stats::phase::idle);
+                            update();
+                        }
+
+                        bool frame = on_demand_ ?
+                            visible_ && (!target_fps_ || pacer_.due()) && redraw_.exchange(false) :
+                            redraw_.exchange(false) || redraw_continuous() || (target_fps_ && pacer_.due());
+                        if (frame)
+                        {
+                            {
+                                frame_stats::section section(stats_, frame_stats::phase::draw);
+                                draw();
+                            }
+                            {
+                                frame_stats::section section(stats_, frame_stats::phase::swap);
+                                present();
+                            }
+                            pacer_.frame();
+                            stats_.frame();
+                            latency_.swapped();
+                            glo::gpu_profiler::current().frame();
+                        }
+                        // paced, or on demand with a draw waiting for its deadline...
+                        else if (target_fps_ && (!on_demand_ || (visible_ && redraw_)))
+                            pacer_.wait();
+                        // nothing to draw until an event, invalidate or redraw arrives...
+                        else
+                            render_wait();
+                    }
+                    if (render_kill_)
+                        kill();
+                    glo::gpu_profiler::release(&glo::gl::current());
+                    release();
+                }
+                catch (...)
+                {
+                    render_error_ = std::current_exception();
+                    quit();
+                }
+            });
     }
-    case WM_RBUTTONDOWN:
+
+    // stop (and join) the render thread, kill is called on it...
+    void render_thread_stop()
     {
-        glwindow_get()->click_begin(glwindow::mouse_button::right);
-        glwindow_get()->mouse_down(LOWORD(lParam), glwindow_get()->height() - HIWORD(lParam), glwindow::mouse_button::right);
-        SetCapture(hWnd);
-        break;
+        {
+            std::lock_guard<std::mutex> lock(render_wake_mutex_);
+            rendering_ = false;
+        }
+        render_wake_.notify_one();
+        if (render_thread_handle_.joinable())
+            render_thread_handle_.join();
     }
-    case WM_RBUTTONUP:
+
+    // wake the render thread from render_wait...
+    void render_wake()
     {
-        int x = LOWORD(lParam);
-        int y = HIWORD(lParam);
-        if (glwindow_get()->is_click(glwindow::mouse_button::right))
-            glwindow_get()->mouse_click(x, glwindow_get()->height() - y, glwindow::mouse_button::right);
-        glwindow_get()->mouse_up(x, glwindow_get()->height() - y, glwindow::mouse_button::right);
-        ReleaseCapture();
-        break;
+        if (!rendering_)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(render_wake_mutex_);
+            render_woken_ = true;
+        }
+        render_wake_.notify_one();
     }
-    case WM_KEYDOWN:
+
+    // sleep the render thread until woken, a replay's events are due on a clock so it polls for them...
+    void render_wait()
     {
-        int ll = LOWORD(lParam);
-        int hl = HIWORD(lParam);
-        int lw = LOWORD(wParam);
-        int hw = HIWORD(wParam);
-        POINT pt; GetCursorPos(&pt); ScreenToClient(hWnd, &pt);
-        glwindow_get()->key_down(pt.x, glwindow_get()->height() - pt.y, static_cast<unsigned int>(wParam));
-        break;
+        std::unique_lock<std::mutex> lock(render_wake_mutex_);
+        if (replaying_)
+            render_wake_.wait_for(lock, std::chrono::milliseconds(1), [this]() { return render_woken_; });
+        else
+            render_wake_.wait(lock, [this]() { return render_woken_ || !rendering_; });
+        render_woken_ = false;
     }
-    case WM_KEYUP:
+
+    // rethrow anything that stopped the render thread...
+    void render_thread_error()
     {
-        POINT pt; GetCursorPos(&pt); ScreenToClient(hWnd, &pt);
-        glwindow_get()->key_up(pt.x, glwindow_get()->height() - pt.y, static_cast<unsigned int>(wParam));
-        break;
+        if (render_error_)
+            std::rethrow_exception(render_error_);
     }
-    case WM_TIMER:
+
+    // run idle at the fixed timestep, as many times as the elapsed time needs, and set the interpolation for draw...
+    void update()
     {
-        if (wParam == IDT_FRAME_TIMER)
+        if (!update_rate_)
         {
-            InvalidateRect(hWnd_, NULL, NULL);
-            UpdateWindow(hWnd_);
+            idle();
+            interpolation_ = 1.0f;
+            return;
         }
-        break;
+
+        auto update_now = std::chrono::steady_clock::now();
+        accumulator_ += std::chrono::duration_cast<std::chrono::nanoseconds>(update_now - update_time_stamp_);
+        update_time_stamp_ = update_now;
+
+        // drop what can't be caught up rather than spiral...
+        if (accumulator_ > timestep_ * max_catch_up_)
+            accumulator_ = timestep_ * max_catch_up_;
+
+        while (accumulator_ >= timestep_)
+        {
+            idle();
+            accumulator_ -= timestep_;
+        }
+        interpolation_ = static_cast<float>(accumulator_.count()) / static_cast<float>(timestep_.count());
     }
-    case WM_DROPFILES:
+
+    // redraw every pass, without a target_fps the swap waits for vblank (vsync) or draws run flat out between fixed updates...
+    bool redraw_continuous() const { return !on_demand_ && !target_fps_ && (swap_interval_ || update_rate_); }
+
+    // Frame deadlines in nanoseconds, each scheduled from the last deadline (not from when the frame happened) so error does not accumulate...
+    class frame_pacer
     {
-        TCHAR szName[MAX_PATH];
-        HDROP hDrop = (HDROP)wParam;
-        int count = DragQueryFile(hDrop, 0xFFFFFFFF, szName, MAX_PATH);
+    public:
+        typedef std::chrono::steady_clock clock;
 
-        std::vector<std::wstring> files;
-        for (int i = 0; i < count; i++)
+        frame_pacer(int fps = 0) { target_fps(fps); }
+
+        void target_fps(int fps)
         {
-            DragQueryFile(hDrop, i, szName, MAX_PATH);
-            files.emplace_back(szName);
+            interval_ = fps > 0 ? std::chrono::nanoseconds(1000000000LL / fps) : std::chrono::nanoseconds::zero();
+            deadline_ = clock::now() + interval_;
         }
-        DragFinish(hDrop);
-        glwindow_get()->drag_drop(files);
-        break;
+        std::chrono::nanoseconds interval() const { return interval_; }
+
+        bool due(clock::time_point now = clock::now()) const { return now >= deadline_; }
+        std::chrono::nanoseconds remaining(clock::time_point now = clock::now()) const { return due(now) ? std::chrono::nanoseconds::zero() : std::chrono::duration_cast<std::chrono::nanoseconds>(deadline_ - now); }
+
+        // the part of the remaining time safe to sleep through, the rest is spun...
+        std::chrono::nanoseconds sleep_time(clock::time_point now = clock::now()) const
+        {
+            std::chrono::nanoseconds r = remaining(now);
+            return r > spin_ ? r - spin_ : std::chrono::nanoseconds::zero();
+        }
+
+        // block until the deadline, sleeping for the bulk and spinning the last few hundred microseconds...
+        void wait()
+        {
+            std::chrono::nanoseconds sleep = sleep_time();
+            if (sleep.count() > 0)
+            {
+                clock::time_point wake = clock::now() + sleep;
+                std::this_thread::sleep_for(sleep);
+                overslept(clock::now() - wake);
+            }
+            while (!due()) {}
+        }
+
+        // feed back how late a sleep woke, the spin window follows the scheduler...
+        void overslept(std::chrono::nanoseconds late)
+        {
+            oversleep_ += (late - oversleep_) / 8;
+            spin_ = oversleep_ * 2;
+            spin_ = spin_ < min_spin_ ? min_spin_ : (spin_ > max_spin_ ? max_spin_ : spin_);
+        }
+
+        // a frame was presented...
+        void frame(clock::time_point now = clock::now())
+        {
+            if (last_frame_ != clock::time_point())
+            {
+                std::chrono::nanoseconds frame_time = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_frame_);
+                frame_time_ = frame_time_.count() ? frame_time_ + (frame_time - frame_time_) / 16 : frame_time;
+                std::chrono::nanoseconds error = frame_time - (interval_.count() ? interval_ : frame_time_);
+                jitter_ += ((error.count() < 0 ? -error : error) - jitter_) / 16;
+            }
+            last_frame_ = now;
+
+            // next deadline, resync rather than burst if frames were dropped...
+            if (interval_.count() && now >= deadline_)
+            {
+                deadline_ += interval_;
+                if (now >= deadline_)
+                    deadline_ = now + interval_;
+            }
+        }
+
+        // achieved frame time and its deviation from the target (moving averages)...
+        std::chrono::nanoseconds frame_time() const { return frame_time_; }
+        std::chrono::nanoseconds jitter() const { return jitter_; }
+
+    private:
+        std::chrono::nanoseconds interval_ = std::chrono::nanoseconds::zero();
+        clock::time_point deadline_;
+        clock::time_point last_frame_;
+        std::chrono::nanoseconds frame_time_ = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds jitter_ = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds oversleep_ = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds spin_ = std::chrono::microseconds(500);
+        std::chrono::nanoseconds min_spin_ = std::chrono::microseconds(200);
+        std::chrono::nanoseconds max_spin_ = std::chrono::milliseconds(4);
+    };
+    frame_pacer& pacer() { return pacer_; }
+
+    // CPU frame statistics, the last capacity frames with each split into the phases of the loop...
+    class frame_stats
+    {
+    public:
+        typedef std::chrono::steady_clock clock;
+        static constexpr std::size_t capacity = 1024;
+
+        // frame is the whole frame (present to present), the rest the time within it spent in each...
+        enum class phase { frame, events, idle, draw, swap };
+        static constexpr int phases = 5;
+
+        // the time spent in scope goes to a phase, nested sections pause the outer one...
+        class section
+        {
+        public:
+            section(frame_stats& stats, phase p) : stats_(stats), previous_(stats.enter(static_cast<int>(p))) {}
+            ~section() { stats_.leave(previous_); }
+        private:
+            frame_stats& stats_;
+            int previous_;
+        };
+
+        // a frame was presented...
+        void frame(clock::time_point now = clock::now())
+        {
+            flush(now);
+            if (first_frame_ == clock::time_point())
+                first_frame_ = now;
+            if (last_frame_ != clock::time_point())
+            {
+                current_[0] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_frame_);
+                ring_[count_ % capacity] = current_;
+                ++count_;
+            }
+            current_.fill(std::chrono::nanoseconds::zero());
+            last_frame_ = now;
+        }
+
+        // frames recorded (up to capacity) and in total...
+        std::size_t size() const { return count_ < capacity ? count_ : capacity; }
+        std::size_t frames() const { return count_; }
+
+        // when the first frame was presented...
+        clock::time_point first_frame() const { return first_frame_; }
+
+        // the time at a percentile (0 to 100) over the recorded frames, e.g. 99 for p99...
+        std::chrono::nanoseconds percentile(double p, phase which = phase::frame) const
+        {
+            std::size_t n = size();
+            if (!n)
+                return std::chrono::nanoseconds::zero();
+
+            std::array<std::chrono::nanoseconds, capacity> values;
+            for (std::size_t f = 0; f < n; ++f)
+                values[f] = ring_[f][static_cast<int>(which)];
+            p = p < 0.0 ? 0.0 : (p > 100.0 ? 100.0 : p);
+            std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(n - 1) + 0.5);
+            std::nth_element(values.begin(), values.begin() + rank, values.begin() + n);
+            return values[rank];
+        }
+
+        std::chrono::nanoseconds mean(phase which = phase::frame) const
+        {
+            std::size_t n = size();
+            std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+            for (std::size_t f = 0; f < n; ++f)
+                total += ring_[f][static_cast<int>(which)];
+            return n ? total / static_cast<std::chrono::nanoseconds::rep>(n) : total;
+        }
+
+        // frames per bucket of the given width from 0, the last bucket also takes everything longer...
+        std::vector<std::size_t> histogram(std::chrono::nanoseconds bucket, std::size_t buckets, phase which = phase::frame) const
+        {
+            std::vector<std::size_t> result(buckets, 0);
+            if (!buckets || bucket.count() <= 0)
+                return result;
+            for (std::size_t f = 0; f < size(); ++f)
+            {
+                std::size_t b = static_cast<std::size_t>(ring_[f][static_cast<int>(which)] / bucket);
+                ++result[b < buckets ? b : buckets - 1];
+            }
+            return result;
+        }
+
+        // one row per recorded frame, oldest first, times in milliseconds...
+        void csv(std::ostream& out) const
+        {
+            out << "frame,frame_ms,events_ms,idle_ms,draw_ms,swap_ms\n";
+            std::size_t n = size();
+            std::size_t first = count_ - n;
+            for (std::size_t f = first; f < count_; ++f)
+            {
+                const sample& row = ring_[f % capacity];
+                out << f;
+                for (int p = 0; p < phases; ++p)
+                    out << ',' << static_cast<double>(row[p].count()) / 1000000.0;
+                out << '\n';
+            }
+        }
+        bool csv(const std::string& filename) const
+        {
+            std::ofstream out(filename);
+            if (!out)
+                return false;
+            csv(out);
+            return static_cast<bool>(out);
+        }
+
+    private:
+        typedef std::array<std::chrono::nanoseconds, phases> sample;
+
+        int enter(int p)
+        {
+            flush(clock::now());
+            int previous = phase_;
+            phase_ = p;
+            return previous;
+        }
+        void leave(int previous)
+        {
+            flush(clock::now());
+            phase_ = previous;
+        }
+        void flush(clock::time_point now)
+        {
+            if (phase_ > 0)
+                current_[phase_] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_start_);
+            phase_start_ = now;
+        }
+
+        std::array<sample, capacity> ring_;
+        std::size_t count_ = 0;
+        sample current_ = sample();
+        int phase_ = 0;         // 0 (frame) when outside any section
+        clock::time_point phase_start_;
+        clock::time_point last_frame_;
+        clock::time_point first_frame_;
+    };
+    frame_stats& stats() { return stats_; }
+
+    // Input to photon latency, from the earliest input a frame consumed to its swap returning, the GPU finishing it
+    // (GL_TIMESTAMP) and it reaching the display (GLX_OML_sync_control, the vblank the swap was seen complete at)...
+    class input_latency
+    {
+    public:
+        typedef std::chrono::steady_clock clock;
+        static constexpr std::size_t capacity = 1024;
+
+        enum class measure { swap, gpu, present };
+
+        struct sample
+        {
+            std::uint64_t swap_;                // swaps of the window so far, including this one
+            std::chrono::nanoseconds swapped_;  // the swap call returned
+            std::chrono::nanoseconds gpu_;      // the GPU finished the frame, zero until known (or if unknown)
+            std::chrono::nanoseconds present_;  // the frame reached the display, zero until known (or if unknown)
+        };
+
+        // the backend's last completed swap and when it was displayed, false if it can't tell...
+        typedef std::function<bool(std::uint64_t&, clock::time_point&)> present_fn;
+        void present_query(present_fn fn) { present_fn_ = fn; }
+
+        // off by default, GPU timestamps cost a query per frame...
+        void enable(bool enabled) { enabled_ = enabled; }
+        bool enabled() const { return enabled_; }
+
+        // input received (on the thread that dispatches)...
+        void input(clock::time_point when)
+        {
+            if (!enabled_)
+                return;
+            if (!input_pending_ || when < input_)
+                input_ = when;
+            input_pending_ = true;
+        }
+
+        // a frame was swapped (on the drawing thread, context current)...
+        void swapped()
+        {
+            ++swaps_;
+            if (!enabled_)
+                return;
+
+            clock::time_point now = clock::now();
+            collect(now);
+            if (!input_pending_)
+                return;
+            input_pending_ = false;
+
+            std::size_t index = count_ % capacity;
+            sample& s = ring_[index];
+            s.swap_ = swaps_;
+            s.swapped_ = std::chrono::duration_cast<std::chrono::nanoseconds>(now - input_);
+            s.gpu_ = std::chrono::nanoseconds::zero();
+            s.present_ = std::chrono::nanoseconds::zero();
+            inputs_[index] = input_;
+            ++count_;
+
+            // the timestamp lands once the GPU has done everything before the swap, flushed so it isn't held for the next frame...
+            if (!gl_)
+            {
+                gl_ = &glo::gl::current();
+                gl_->glGenQueries(queries, queries_);
+            }
+            pending& q = pending_[query_];
+            if (!q.active_)
+            {
+                gl_->glQueryCounter(queries_[query_], GL_TIMESTAMP);
+                glFlush();
+                q.active_ = true;
+                q.sample_ = count_ - 1;
+                query_ = (query_ + 1) % queries;
+            }
+        }
+
+        // samples recorded (up to capacity) and in total...
+        std::size_t size() const { return count_ < capacity ? count_ : capacity; }
+        std::size_t samples() const { return count_; }
+
+        // the latest samples, n = 0 the most recent, its gpu and present times may still be unknown...
+        const sample& latest(std::size_t n = 0) const
+        {
+            if (n >= size())
+                throw std::runtime_error("No such latency sample.");
+            return ring_[(count_ - 1 - n) % capacity];
+        }
+
+        // over the recorded samples where the measure is known, zero if none...
+        std::chrono::nanoseconds percentile(double p, measure which = measure::swap) const
+        {
+            std::array<std::chrono::nanoseconds, capacity> values;
+            std::size_t n = known(which, values);
+            if (!n)
+                return std::chrono::nanoseconds::zero();
+            p = p < 0.0 ? 0.0 : (p > 100.0 ? 100.0 : p);
+            std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(n - 1) + 0.5);
+            std::nth_element(values.begin(), values.begin() + rank, values.begin() + n);
+            return values[rank];
+        }
+
+        std::chrono::nanoseconds mean(measure which = measure::swap) const
+        {
+            std::array<std::chrono::nanoseconds, capacity> values;
+            std::size_t n = known(which, values);
+            std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+            for (std::size_t v = 0; v < n; ++v)
+                total += values[v];
+            return n ? total / static_cast<std::chrono::nanoseconds::rep>(n) : total;
+        }
+
+    private:
+        static constexpr int queries = 8;
+
+        struct pending
+        {
+            bool active_ = false;
+            std::size_t sample_ = 0;
+        };
+
+        // GPU timestamps that have landed (in order) and displayed swaps...
+        void collect(clock::time_point now)
+        {
+            if (gl_)
+            {
+                // the GPU clock against ours, taken now so drift doesn't matter...
+                GLint64 gpu_now = 0;
+                gl_->glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+                std::int64_t offset = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count() - gpu_now;
+
+                for (int q = 0; q < queries; ++q)
+                {
+                    int slot = (query_ + q) % queries;
+                    pending& p = pending_[slot];
+                    if (!p.active_)
+                        continue;
+                    GLint available = 0;
+                    gl_->glGetQueryObjectiv(queries_[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+                    if (!available)
+                        break;
+                    GLuint64 gpu = 0;
+                    gl_->glGetQueryObjectui64v(queries_[slot], GL_QUERY_RESULT, &gpu);
+                    p.active_ = false;
+                    if (count_ - p.sample_ <= capacity)
+                    {
+                        std::size_t index = p.sample_ % capacity;
+                        clock::time_point done = clock::time_point(std::chrono::duration_cast<clock::duration>(std::chrono::nanoseconds(static_cast<std::int64_t>(gpu) + offset)));
+                        ring_[index].gpu_ = std::chrono::duration_cast<std::chrono::nanoseconds>(done - inputs_[index]);
+                    }
+                }
+            }
+
+            std::uint64_t displayed = 0;
+            clock::time_point when;
+            if (present_fn_ && present_fn_(displayed, when))
+            {
+                for (std::size_t n = 0; n < size(); ++n)
+                {
+                    std::size_t index = (count_ - 1 - n) % capacity;
+                    sample& s = ring_[index];
+                    if (s.swap_ > displayed)
+                        continue;
+                    if (s.present_ != std::chrono::nanoseconds::zero())
+                        break;
+                    s.present_ = std::chrono::duration_cast<std::chrono::nanoseconds>(when - inputs_[index]);
+                }
+            }
+        }
+
+        std::size_t known(measure which, std::array<std::chrono::nanoseconds, capacity>& values) const
+        {
+            std::size_t n = 0;
+            for (std::size_t f = 0; f < size(); ++f)
+            {
+                const sample& s = ring_[f];
+                std::chrono::nanoseconds v = which == measure::swap ? s.swapped_ : (which == measure::gpu ? s.gpu_ : s.present_);
+                if (v != std::chrono::nanoseconds::zero())
+                    values[n++] = v;
+            }
+            return n;
+        }
+
+        bool enabled_ = false;
+        bool input_pending_ = false;
+        clock::time_point input_;
+        std::uint64_t swaps_ = 0;
+        std::array<sample, capacity> ring_{};
+        std::array<clock::time_point, capacity> inputs_{};
+        std::size_t count_ = 0;
+        const glo::gl* gl_ = nullptr;
+        GLuint queries_[queries];
+        pending pending_[queries];
+        int query_ = 0;
+        present_fn present_fn_;
+    };
+    input_latency& latency() { return latency_; }
+
+    // mouse click handler...
+    void click_begin(mouse_button button)
+    {
+        mouse_time_stamp_ = std::chrono::steady_clock::now();
+        mouse_button_ = button;
+    }
+    bool is_click(mouse_button button) const { return (button == mouse_button_ && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mouse_time_stamp_).count() < glwindow_get()->click_duration_); }
+    bool frame_limiter()
+    {
+        if (target_fps_)
+        {
+            auto fps_now = std::chrono::steady_clock::now();
+            if (limiter_.due(fps_now))
+            {
+                limiter_.frame(fps_now);
+                return true;
+            }
+            return false;
+        }
+        return true;
+    }
+protected:
+
+    const glwindow_str& window_title() const { return window_title_; }
+    bool window_fullscreen() const { return fullscreen_; }
+    int window_height() const { return window_height_; }
+    int window_width() const { return window_width_; }
+    int window_target_fps() const { return target_fps_; }
+    int window_click_duration() const { return click_duration_; }
+    int window_swap_interval() const { return swap_interval_; }
+    int window_update_rate() const { return update_rate_; }
+    float window_interpolation() const { return interpolation_; }
+
+    void window_title(const glwindow_str& title) { window_title_ = title; }
+    void window_fullscreen(bool fs) { fullscreen_ = fs; }
+    void window_height(int height) { window_height_ = height; }
+    void window_width(int width) { window_width_ = width; }
+    void window_target_fps(int fps) { target_fps_ = fps; pacer_.target_fps(fps); limiter_.target_fps(fps); }
+    void window_click_duration(int duration) { click_duration_ = duration; }
+    void window_swap_interval(int interval) { swap_interval_ = interval; if (context_) context_->swap_interval(interval); }
+
+    static glwindow*& current_window() { static thread_local glwindow* window = nullptr; return window; }
+    static std::vector<startup_phase>& startup_phases() { static std::vector<startup_phase> phases; return phases; }
+    static std::chrono::steady_clock::time_point& startup_origin() { static std::chrono::steady_clock::time_point origin; return origin; }
+
+    // every delivered event passes through here...
+    void handle(const event& e)
+    {
+        if (record_file_.is_open())
+            record_event(e);
+        if (on_demand_)
+            redraw_ = true;
+        dispatch(e);
+    }
+
+    // recording, little endian "GLOR" v1 then per event: type u8, frame u32, time (ns) u64, x, y, value i32,
+    // for drag_drop a file count u32 then each file as a length u32 and its characters u32...
+    static constexpr std::uint32_t record_version = 1;
+
+    struct recorded
+    {
+        std::uint32_t frame_;
+        std::chrono::nanoseconds time_;
+        event event_;
+    };
+
+    static void record_write(std::ostream& out, std::uint64_t value, int bytes)
+    {
+        char data[8];
+        for (int b = 0; b < bytes; ++b)
+            data[b] = static_cast<char>((value >> (b * 8)) & 0xff);
+        out.write(data, bytes);
+    }
+
+    static std::uint64_t record_read(std::istream& in, int bytes)
+    {
+        unsigned char data[8];
+        if (!in.read(reinterpret_cast<char*>(data), bytes))
+            throw std::runtime_error("glwindow recording truncated.");
+        std::uint64_t value = 0;
+        for (int b = 0; b < bytes; ++b)
+            value |= static_cast<std::uint64_t>(data[b]) << (b * 8);
+        return value;
+    }
+
+    void window_record(const std::string& filename)
+    {
+        record_file_.close();
+        if (filename.empty())
+            return;
+
+        record_file_.open(filename, std::ios::binary | std::ios::trunc);
+        if (!record_file_)
+            throw std::runtime_error("glwindow can't open recording " + filename + ".");
+        record_file_.write("GLOR", 4);
+        record_write(record_file_, record_version, 4);
+        record_frame_ = 0;
+        record_started_ = false;
+    }
+
+    // time from the first frame or event recorded...
+    std::chrono::nanoseconds record_clock()
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!record_started_)
+        {
+            record_start_ = now;
+            record_started_ = true;
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now - record_start_);
+    }
+
+    void record_event(const event& e)
+    {
+        record_write(record_file_, static_cast<std::uint64_t>(e.type_), 1);
+        record_write(record_file_, record_frame_, 4);
+        record_write(record_file_, static_cast<std::uint64_t>(record_clock().count()), 8);
+        record_write(record_file_, static_cast<std::uint32_t>(e.x_), 4);
+        record_write(record_file_, static_cast<std::uint32_t>(e.y_), 4);
+        record_write(record_file_, static_cast<std::uint32_t>(e.value_), 4);
+        if (e.type_ == event::event_type::drag_drop)
+        {
+            record_write(record_file_, e.files_.size(), 4);
+            for (auto file = e.files_.begin(); file != e.files_.end(); ++file)
+            {
+                record_write(record_file_, file->size(), 4);
+                for (auto c = file->begin(); c != file->end(); ++c)
+                    record_write(record_file_, static_cast<std::uint32_t>(*c), 4);
+            }
+        }
+    }
+
+    void window_replay(const std::string& filename, double speed)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[4];
+        if (!in || !in.read(magic, 4) || std::memcmp(magic, "GLOR", 4) != 0)
+            throw std::runtime_error("glwindow can't read recording " + filename + ".");
+        if (record_read(in, 4) != record_version)
+            throw std::runtime_error("glwindow recording " + filename + " has an unsupported version.");
+
+        std::vector<recorded> events;
+        while (in.peek() != std::char_traits<char>::eof())
+        {
+            recorded r;
+            std::uint64_t type = record_read(in, 1);
+            if (type > static_cast<std::uint64_t>(event::event_type::drag_drop))
+                throw std::runtime_error("glwindow recording " + filename + " is corrupt.");
+            r.event_.type_ = static_cast<event::event_type>(type);
+            r.frame_ = static_cast<std::uint32_t>(record_read(in, 4));
+            r.time_ = std::chrono::nanoseconds(static_cast<std::int64_t>(record_read(in, 8)));
+            r.event_.x_ = static_cast<std::int32_t>(record_read(in, 4));
+            r.event_.y_ = static_cast<std::int32_t>(record_read(in, 4));
+            r.event_.value_ = static_cast<std::int32_t>(record_read(in, 4));
+            if (r.event_.type_ == event::event_type::drag_drop)
+            {
+                r.event_.files_.resize(static_cast<std::size_t>(record_read(in, 4)));
+                for (auto file = r.event_.files_.begin(); file != r.event_.files_.end(); ++file)
+                {
+                    file->resize(static_cast<std::size_t>(record_read(in, 4)));
+                    for (auto c = file->begin(); c != file->end(); ++c)
+                        *c = static_cast<wchar_t>(record_read(in, 4));
+                }
+            }
+            events.push_back(std::move(r));
+        }
+
+        replay_.swap(events);
+        replay_next_ = 0;
+        replay_speed_ = speed > 0.0 ? speed : 0.0;
+        replay_started_ = false;
+        replaying_ = !replay_.empty();
+    }
+
+    // deliver the recorded events due by this frame...
+    void replay_frame()
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!replay_started_)
+        {
+            replay_start_ = now;
+            replay_frame_ = 0;
+            replay_started_ = true;
+        }
+
+        double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - replay_start_).count()) * replay_speed_;
+        while (replay_next_ < replay_.size())
+        {
+            const recorded& r = replay_[replay_next_];
+            bool due = replay_speed_ > 0.0 ? static_cast<double>(r.time_.count()) <= elapsed : r.frame_ <= replay_frame_;
+            if (!due)
+                break;
+            ++replay_next_;
+            if (on_demand_)
+                redraw_ = true;
+            latency_.input(now);
+            dispatch(r.event_);
+        }
+        ++replay_frame_;
+
+        if (replay_next_ == replay_.size())
+        {
+            replaying_ = false;
+            replay_.clear();
+        }
+    }
+
+    void window_update_rate(int rate)
+    {
+        update_rate_ = rate;
+        timestep_ = rate > 0 ? std::chrono::nanoseconds(1000000000LL / rate) : std::chrono::nanoseconds::zero();
+        accumulator_ = std::chrono::nanoseconds::zero();
+        update_time_stamp_ = std::chrono::steady_clock::now();
+    }
+
+private:
+    idle_fn idle_fn_ = nullptr;
+    draw_fn draw_fn_ = nullptr;
+    kill_fn kill_fn_ = nullptr;
+    resize_fn resize_fn_ = nullptr;
+    mouse_move_fn mouse_move_fn_ = nullptr;
+    mouse_up_fn mouse_up_fn_ = nullptr;
+    mouse_click_fn mouse_click_fn_ = nullptr;
+    mouse_down_fn mouse_down_fn_ = nullptr;
+    mouse_scroll_fn mouse_scroll_fn_ = nullptr;
+    key_up_fn key_up_fn_ = nullptr;
+    key_down_fn key_down_fn_ = nullptr;
+    drag_drop_fn drag_drop_fn_ = nullptr;
+
+    glwindow_str window_title_ = L"glwindow";
+    std::atomic<int> window_width_{ 800 };
+    std::atomic<int> window_height_{ 600 };
+    bool fullscreen_ = false;
+    int target_fps_ = 60;
+    int click_duration_ = 200;
+    int swap_interval_ = 0;
+
+    // fixed timestep...
+    int update_rate_ = 0;
+    int max_catch_up_ = 8;
+    std::chrono::nanoseconds timestep_ = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds accumulator_ = std::chrono::nanoseconds::zero();
+    std::chrono::steady_clock::time_point update_time_stamp_ = std::chrono::steady_clock::now();
+    float interpolation_ = 1.0f;
+
+    // frame pacing (backends) and the frame_limiter poll...
+    frame_pacer pacer_ = frame_pacer(target_fps_);
+    frame_pacer limiter_ = frame_pacer(target_fps_);
+
+    // frame statistics, always collected...
+    frame_stats stats_;
+    std::string stats_csv_;
+    input_latency latency_;
+
+    // mouse click handler...
+    std::chrono::steady_clock::time_point mouse_time_stamp_ = std::chrono::steady_clock::now();
+    mouse_button mouse_button_ = mouse_button::none;
+
+    std::shared_ptr<glcontext> context_;
+
+    // render thread...
+    bool render_thread_ = false;
+    std::atomic<bool> rendering_{ false };
+    std::atomic<bool> render_kill_{ true };
+    std::atomic<bool> redraw_{ true };
+    std::thread render_thread_handle_;
+    std::exception_ptr render_error_;
+    std::mutex render_wake_mutex_;
+    std::condition_variable render_wake_;
+    bool render_woken_ = false;
+    std::unique_ptr<glo::spsc_queue<event, 4096>> events_;     // only with the render thread (large)
+
+    // on demand redraw...
+    bool on_demand_ = false;
+    std::atomic<bool> visible_{ true };
+    std::function<void()> wake_fn_;
+
+    // event coalescing (on the thread that dispatches)...
+    bool coalesce_ = true;
+    bool coalesce_history_ = false;
+    bool move_pending_ = false;
+    bool resize_pending_ = false;
+    event pending_move_;
+    event pending_resize_;
+    std::vector<event> history_;
+    std::vector<event> history_frame_;
+
+    // event recording and replay (on the thread that dispatches)...
+    std::ofstream record_file_;
+    std::uint32_t record_frame_ = 0;
+    bool record_started_ = false;
+    std::chrono::steady_clock::time_point record_start_;
+    std::vector<recorded> replay_;
+    std::size_t replay_next_ = 0;
+    std::uint32_t replay_frame_ = 0;
+    double replay_speed_ = 1.0;
+    bool replay_started_ = false;
+    bool replaying_ = false;
+    std::chrono::steady_clock::time_point replay_start_;
+};
+
+// Static dispatch window, derived hides the on_ handlers it needs and they are called (and inlined) directly, no std::function...
+//
+//  class mywindow : public glwindow_t<mywindow>
+//  {
+//  public:
+//      void on_draw() { ... }
+//      void on_mouse_move(int x, int y) { ... }
+//  };
+//  GLWINDOW_CLASS(3, 3, mywindow) { ... }
+template <typename derived>
+class glwindow_t : public glwindow
+{
+public:
+    using glwindow::glwindow;
+
+    void on_idle() {}
+    void on_draw() {}
+    void on_kill() {}
+    void on_resize(int, int) {}
+    void on_mouse_move(int, int) {}
+    void on_mouse_down(int, int, mouse_button) {}
+    void on_mouse_up(int, int, mouse_button) {}
+    void on_mouse_click(int, int, mouse_button) {}
+    void on_mouse_scroll(int, int, int) {}
+    void on_key_down(int, int, unsigned int) {}
+    void on_key_up(int, int, unsigned int) {}
+    void on_drag_drop(const std::vector<std::wstring>&) {}
+
+    void idle() final { self().on_idle(); }
+    void draw() final { self().on_draw(); }
+    void kill() final { self().on_kill(); }
+    void resize(int width, int height) final { self().on_resize(width, height); }
+    void mouse_move(int x, int y) final { self().on_mouse_move(x, y); }
+    void mouse_down(int x, int y, mouse_button button) final { self().on_mouse_down(x, y, button); }
+    void mouse_up(int x, int y, mouse_button button) final { self().on_mouse_up(x, y, button); }
+    void mouse_click(int x, int y, mouse_button button) final { self().on_mouse_click(x, y, button); }
+    void mouse_scroll(int x, int y, int value) final { self().on_mouse_scroll(x, y, value); }
+    void key_down(int x, int y, unsigned int key) final { self().on_key_down(x, y, key); }
+    void key_up(int x, int y, unsigned int key) final { self().on_key_up(x, y, key); }
+    void drag_drop(std::vector<std::wstring> files) final { self().on_drag_drop(files); }
+
+    // one virtual call per event, the handler itself is resolved at compile time...
+    void dispatch(const event& e) final
+    {
+        switch (e.type_)
+        {
+        case event::event_type::mouse_move: self().on_mouse_move(e.x_, e.y_); break;
+        case event::event_type::mouse_down: self().on_mouse_down(e.x_, e.y_, static_cast<mouse_button>(e.value_)); break;
+        case event::event_type::mouse_up: self().on_mouse_up(e.x_, e.y_, static_cast<mouse_button>(e.value_)); break;
+        case event::event_type::mouse_click: self().on_mouse_click(e.x_, e.y_, static_cast<mouse_button>(e.value_)); break;
+        case event::event_type::mouse_scroll: self().on_mouse_scroll(e.x_, e.y_, e.value_); break;
+        case event::event_type::key_down: self().on_key_down(e.x_, e.y_, static_cast<unsigned int>(e.value_)); break;
+        case event::event_type::key_up: self().on_key_up(e.x_, e.y_, static_cast<unsigned int>(e.value_)); break;
+        case event::event_type::resize: self().on_resize(e.x_, e.y_); break;
+        case event::event_type::drag_drop: self().on_drag_drop(e.files_); break;
+        }
+    }
+
+private:
+    derived& self() { return *static_cast<derived*>(this); }
+};
+
+
+// Windows platform implementation...
+#ifdef GLO_WIN
+
+static HWND hWnd_;
+static HINSTANCE hInst_;
+static WNDCLASSEX wcex_;
+
+// 1ms scheduler resolution for the frame pacer sleeps...
+#pragma comment(lib, "winmm.lib")
+
+// A context for a worker thread, current on the window's DC but never drawn to it...
+class glcontext_shared : public glwindow::glcontext
+{
+public:
+    glcontext_shared(HDC hdc, int major_version, int minor_version, HGLRC share, const glo::gl& dispatch)
+        : hDC_(hdc)
+    {
+        if (major_version)
+        {
+            int attribs[] =
+            {
+                WGL_CONTEXT_MAJOR_VERSION_ARB, major_version,
+                WGL_CONTEXT_MINOR_VERSION_ARB, minor_version,
+                WGL_CONTEXT_FLAGS_ARB, 0,
+                0
+            };
+
+            // resolved with the shared context current (the drawing thread)...
+            PFNWGLCREATECONTEXTATTRIBSARBPROC glwindow_context_shared_wglCreateContextAttribsARB = (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
+            if (glwindow_context_shared_wglCreateContextAttribsARB)
+                hGLrc_ = glwindow_context_shared_wglCreateContextAttribsARB(hDC_, share, attribs);
+        }
+        else
+        {
+            hGLrc_ = wglCreateContext(hDC_);
+            if (hGLrc_ && !wglShareLists(share, hGLrc_))
+            {
+                wglDeleteContext(hGLrc_);
+                hGLrc_ = NULL;
+            }
+        }
+        if (!hGLrc_)
+            throw std::runtime_error("Unable to create shared GL context.");
+
+        // same driver as the context shared, same entry points...
+        dispatch_ = dispatch;
+    }
+    ~glcontext_shared() { wglDeleteContext(hGLrc_); }
+
+    void attach()
+    {
+        if (!wglMakeCurrent(hDC_, hGLrc_))
+            throw std::runtime_error("Unable to make current.");
+        glo::gl::current(&dispatch_);
+    }
+    void detach() { glo::gpu_profiler::release(&dispatch_); glo::gl::current(nullptr); wglMakeCurrent(NULL, NULL); }
+
+private:
+    HDC hDC_;
+    HGLRC hGLrc_ = NULL;
+};
+
+// choose and set the window's pixel format (once per window)...
+static void pixel_format_win(HDC hDC)
+{
+    if (!hDC)
+        throw std::runtime_error("No device context.");
+
+    PIXELFORMATDESCRIPTOR pfd;
+    memset(&pfd, 0, sizeof(PIXELFORMATDESCRIPTOR));
+    pfd.nSize = sizeof(PIXELFORMATDESCRIPTOR);
+    pfd.nVersion = 1;
+    pfd.dwFlags = PFD_DOUBLEBUFFER | PFD_SUPPORT_OPENGL | PFD_DRAW_TO_WINDOW;
+    pfd.iPixelType = PFD_TYPE_RGBA;
+    pfd.cColorBits = 32;
+    pfd.cDepthBits = 32;
+    pfd.cStencilBits = 8;
+    pfd.iLayerType = PFD_MAIN_PLANE;
+
+    int nPixelFormat = ChoosePixelFormat(hDC, &pfd);
+
+    if (nPixelFormat == 0)
+        throw std::runtime_error("Unable to choose pixel format.");
+
+    if (!SetPixelFormat(hDC, nPixelFormat, &pfd))
+        throw std::runtime_error("Unable to set pixel format.");
+}
+
+// wglCreateContextAttribsARB, resolving it needs a current context so a legacy one is made once per process and
+// only if no context is current, later contexts (further windows, workers) use the cached entry point...
+static PFNWGLCREATECONTEXTATTRIBSARBPROC create_context_attribs_win(HDC hDC)
+{
+    static PFNWGLCREATECONTEXTATTRIBSARBPROC create_context_attribs = NULL;
+    static bool resolved = false;
+    if (resolved)
+        return create_context_attribs;
+
+    HGLRC current = wglGetCurrentContext();
+    HDC current_dc = wglGetCurrentDC();
+    HGLRC bootstrap = NULL;
+    if (!current)
+    {
+        bootstrap = wglCreateContext(hDC);
+        if (!bootstrap || !wglMakeCurrent(hDC, bootstrap))
+            throw std::runtime_error("Unable to create GL context.");
+    }
+    create_context_attribs = (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
+    resolved = true;
+    if (bootstrap)
+    {
+        wglMakeCurrent(NULL, NULL);
+        wglDeleteContext(bootstrap);
+    }
+    else
+        wglMakeCurrent(current_dc, current);
+    return create_context_attribs;
+}
+
+// The contexts...
+class glcontext_base : public glwindow::glcontext
+{
+public:
+    glcontext_base(void* hdc, HGLRC share = NULL)
+        : hDC_(static_cast<HDC>(hdc))
+    {
+        HDC hDC = static_cast<HDC>(hdc);
+        pixel_format_win(hDC);
+
+        hGLrc_ = wglCreateContext(hDC);
+        if (share && !wglShareLists(share, hGLrc_))
+            throw std::runtime_error("Unable to share GL context.");
+        wglMakeCurrent(hDC, hGLrc_);
+
+        // resolve the entry points once for this context...
+        dispatch_.load();
+        glo::gl::current(&dispatch_);
+    }
+
+    void free(void* hdc) { glo::gpu_profiler::release(&dispatch_); glo::gl::current(nullptr); wglDeleteContext(hGLrc_); }
+    void make_current(void* hdc) { wglMakeCurrent(static_cast<HDC>(hdc), hGLrc_); glo::gl::current(&dispatch_); }
+
+    HGLRC handle() const { return hGLrc_; }
+
+    std::shared_ptr<glwindow::glcontext> shared()
+    {
+        return std::make_shared<glcontext_shared>(hDC_, major_version_, minor_version_, hGLrc_, dispatch_);
+    }
+
+    bool swap_interval(int interval)
+    {
+        PFNWGLSWAPINTERVALEXTPROC glwindow_context_wglSwapIntervalEXT = (PFNWGLSWAPINTERVALEXTPROC)wglGetProcAddress("wglSwapIntervalEXT");
+        if (!glwindow_context_wglSwapIntervalEXT)
+            return false;
+
+        // adaptive needs WGL_EXT_swap_control_tear...
+        PFNWGLGETEXTENSIONSSTRINGEXTPROC glwindow_context_wglGetExtensionsStringEXT = (PFNWGLGETEXTENSIONSSTRINGEXTPROC)wglGetProcAddress("wglGetExtensionsStringEXT");
+        if (interval < 0 && !(glwindow_context_wglGetExtensionsStringEXT && strstr(glwindow_context_wglGetExtensionsStringEXT(), "WGL_EXT_swap_control_tear")))
+            interval = -interval;
+        return glwindow_context_wglSwapIntervalEXT(interval) == TRUE;
+    }
+
+protected:
+    glcontext_base(HDC hDC, int major_version, int minor_version) : hDC_(hDC), major_version_(major_version), minor_version_(minor_version) {}
+
+    HDC hDC_;
+    HGLRC hGLrc_ = NULL;
+    int major_version_ = 0;     // 0 when not versioned
+    int minor_version_ = 0;
+};
+
+class glcontext_extended : public glcontext_base
+{
+public:
+    glcontext_extended(void* hdc, int major_version, int minor_version, HGLRC share = NULL)
+        : glcontext_base(static_cast<HDC>(hdc), major_version, minor_version)
+    {
+        int attribs[] =
+        {
+            WGL_CONTEXT_MAJOR_VERSION_ARB, major_version,
+            WGL_CONTEXT_MINOR_VERSION_ARB, minor_version,
+            WGL_CONTEXT_FLAGS_ARB, 0,
+            0
+        };
+
+        // the versioned context directly, legacy only if the driver can't...
+        pixel_format_win(hDC_);
+        PFNWGLCREATECONTEXTATTRIBSARBPROC create_context_attribs = create_context_attribs_win(hDC_);
+        if (create_context_attribs)
+            hGLrc_ = create_context_attribs(hDC_, share, attribs);
+        else
+        {
+            major_version_ = minor_version_ = 0;
+            hGLrc_ = wglCreateContext(hDC_);
+            if (share && hGLrc_ && !wglShareLists(share, hGLrc_))
+                throw std::runtime_error("Unable to share GL context.");
+        }
+        if (!hGLrc_)
+            throw std::runtime_error("Unable to create GL context.");
+        if (!wglMakeCurrent(hDC_, hGLrc_))
+            throw std::runtime_error("Unable to make current.");
+
+        // resolve the entry points once for this context...
+        dispatch_.load();
+        glo::gl::current(&dispatch_);
+    }
+};
+
+// Further windows (glwindow::open), drawn after the main window each frame...
+struct glwindow_view_win
+{
+    std::shared_ptr<glwindow> window_;
+    HWND hwnd_;
+};
+static std::vector<glwindow_view_win> views_;
+
+static glcontext_base* context_win(glwindow* window)
+{
+    return static_cast<glcontext_base*>(window->context());
+}
+
+// not minimized and not fully covered (a covered window only clips to nothing without desktop composition)...
+static bool visible_win(HWND hWnd)
+{
+    if (IsIconic(hWnd) || !IsWindowVisible(hWnd))
+        return false;
+    RECT clip;
+    HDC hDC = GetDC(hWnd);
+    int region = GetClipBox(hDC, &clip);
+    ReleaseDC(hWnd, hDC);
+    return region != NULLREGION;
+}
+
+// the main window's context is current other than while a further window is handled...
+static void main_current_win()
+{
+    glwindow::current_scope scope(nullptr);
+    context_win(glwindow_get())->make_current(GetDC(hWnd_));
+}
+
+// deliver and update the further windows, each with its own context current...
+static void run_views_win()
+{
+    if (views_.empty())
+        return;
+
+    // by copy and index, a handler opening a window adds to views_...
+    const std::size_t count = views_.size();
+    for (std::size_t v = 0; v < count && v < views_.size(); ++v)
+    {
+        glwindow_view_win view = views_[v];
+        glwindow::current_scope scope(view.window_.get());
+        context_win(view.window_.get())->make_current(GetDC(view.hwnd_));
+        glwindow::frame_stats& stats = view.window_->stats();
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+            view.window_->deliver_frame();
+        }
+        glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::idle);
+        view.window_->update();
+    }
+    main_current_win();
+}
+
+// a window's messages...
+static LRESULT window_proc_win(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam, bool view)
+{
+    switch (message)
+    {
+    case WM_DESTROY:
+    {
+        // a further window closing, the rest carry on...
+        if (view)
+        {
+            glwindow_get()->kill();
+            if (glwindow_get()->context())
+                context_win(glwindow_get())->free(GetDC(hWnd));
+            SetWindowLongPtr(hWnd, GWLP_USERDATA, 0);
+            for (auto v = views_.begin(); v != views_.end(); ++v)
+            {
+                if (v->hwnd_ == hWnd)
+                {
+                    views_.erase(v);
+                    break;
+                }
+            }
+            break;
+        }
+
+        // closing the main window closes them all...
+        while (!views_.empty())
+            DestroyWindow(views_.back().hwnd_);
+
+        timeEndPeriod(1);
+        if (glwindow_get()->render_thread())
+            glwindow_get()->render_thread_stop();
+        else
+            glwindow_get()->kill();
+        PostQuitMessage(0);
+        break;
+    }
+    case WM_ERASEBKGND:
+        return 1;
+    case WM_PAINT:
+    {
+        PAINTSTRUCT ps;
+        BeginPaint(hWnd, &ps);
+        if (glwindow_get()->render_thread())
+            glwindow_get()->post_redraw();
+        else
+        {
+            // may be painted from within a modal size/move loop, deliver the latest size first...
+            glwindow::frame_stats& stats = glwindow_get()->stats();
+            glwindow_get()->take_redraw();
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+                glwindow_get()->deliver_pending();
+            }
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::draw);
+                glwindow_get()->draw();
+            }
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::swap);
+                SwapBuffers(GetDC(hWnd));
+            }
+            glwindow_get()->pacer().frame();
+            stats.frame();
+            glwindow_get()->latency().swapped();
+            glo::gpu_profiler::current().frame();
+        }
+        EndPaint(hWnd, &ps);
+        break;
+    }
+    case WM_SIZE:
+    {
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::resize, static_cast<int>(LOWORD(lParam)), static_cast<int>(HIWORD(lParam))));
+        break;
+    }
+    case WM_MOUSEWHEEL:
+    {
+        POINT pt; pt.x = LOWORD(lParam); pt.y = HIWORD(lParam); ScreenToClient(hWnd, &pt);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_scroll, pt.x, pt.y, GET_WHEEL_DELTA_WPARAM(wParam)));
+        break;
+    }
+    case WM_MOUSEMOVE:
+    {
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_move, LOWORD(lParam), HIWORD(lParam)));
+        break;
+    }
+    case WM_LBUTTONDOWN:
+    {
+        glwindow_get()->click_begin(glwindow::mouse_button::left);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_down, LOWORD(lParam), glwindow_get()->height() - HIWORD(lParam), glwindow::mouse_button::left));
+        SetCapture(hWnd);
+        break;
+    }
+    case WM_LBUTTONUP:
+    {
+        int x = LOWORD(lParam);
+        int y = HIWORD(lParam);
+        if (glwindow_get()->is_click(glwindow::mouse_button::left))
+            glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_click, x, glwindow_get()->height() - y, glwindow::mouse_button::left));
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_up, x, glwindow_get()->height() - y, glwindow::mouse_button::left));
+        ReleaseCapture();
+        break;
+    }
+    case WM_MBUTTONDOWN:
+    {
+        glwindow_get()->click_begin(glwindow::mouse_button::middle);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_down, LOWORD(lParam), glwindow_get()->height() - HIWORD(lParam), glwindow::mouse_button::middle));
+        SetCapture(hWnd);
+        break;
+    }
+    case WM_MBUTTONUP:
+    {
+        int x = LOWORD(lParam);
+        int y = HIWORD(lParam);
+        if (glwindow_get()->is_click(glwindow::mouse_button::middle))
+            glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_click, x, glwindow_get()->height() - y, glwindow::mouse_button::middle));
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_up, x, glwindow_get()->height() - y, glwindow::mouse_button::middle));
+        ReleaseCapture();
+        break;
+    }
+    case WM_RBUTTONDOWN:
+    {
+        glwindow_get()->click_begin(glwindow::mouse_button::right);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_down, LOWORD(lParam), glwindow_get()->height() - HIWORD(lParam), glwindow::mouse_button::right));
+        SetCapture(hWnd);
+        break;
+    }
+    case WM_RBUTTONUP:
+    {
+        int x = LOWORD(lParam);
+        int y = HIWORD(lParam);
+        if (glwindow_get()->is_click(glwindow::mouse_button::right))
+            glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_click, x, glwindow_get()->height() - y, glwindow::mouse_button::right));
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_up, x, glwindow_get()->height() - y, glwindow::mouse_button::right));
+        ReleaseCapture();
+        break;
+    }
+    case WM_KEYDOWN:
+    {
+        int ll = LOWORD(lParam);
+        int hl = HIWORD(lParam);
+        int lw = LOWORD(wParam);
+        int hw = HIWORD(wParam);
+        POINT pt; GetCursorPos(&pt); ScreenToClient(hWnd, &pt);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::key_down, pt.x, glwindow_get()->height() - pt.y, static_cast<int>(wParam)));
+        break;
+    }
+    case WM_KEYUP:
+    {
+        POINT pt; GetCursorPos(&pt); ScreenToClient(hWnd, &pt);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::key_up, pt.x, glwindow_get()->height() - pt.y, static_cast<int>(wParam)));
+        break;
+    }
+    case WM_DROPFILES:
+    {
+        TCHAR szName[MAX_PATH];
+        HDROP hDrop = (HDROP)wParam;
+        int count = DragQueryFile(hDrop, 0xFFFFFFFF, szName, MAX_PATH);
+
+        std::vector<std::wstring> files;
+        for (int i = 0; i < count; i++)
+        {
+            DragQueryFile(hDrop, i, szName, MAX_PATH);
+            files.emplace_back(szName);
+        }
+        DragFinish(hDrop);
+        glwindow_get()->post(glwindow::event(files));
+        break;
+    }
+    default:
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+    return 0;
+}
+
+// windows main callback, routes to the window the message is for...
+static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    // further windows carry their glwindow, statics resolve to it and GL calls go to its context...
+    if (message == WM_NCCREATE)
+        SetWindowLongPtr(hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(reinterpret_cast<CREATESTRUCT*>(lParam)->lpCreateParams));
+    glwindow* view = reinterpret_cast<glwindow*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+    glwindow::current_scope scope(view);
+    if (view && view->context())
+        context_win(view)->make_current(GetDC(hWnd));
+
+    LRESULT result = window_proc_win(hWnd, message, wParam, lParam, view != nullptr);
+
+    if (view)
+        main_current_win();
+    return result;
+}
+
+static std::wstring ansi_to_wide(const std::string& str)
+{
+    int count = MultiByteToWideChar(CP_ACP, 0, str.c_str(), static_cast<int>(str.length()), NULL, 0);
+    std::wstring wstr(count, 0);
+    MultiByteToWideChar(CP_ACP, 0, str.c_str(), static_cast<int>(str.length()), &wstr[0], count);
+    return wstr;
+}
+
+static std::string get_last_error_as_string()
+{
+    //Get the error message ID, if any.
+    DWORD errorMessageID = ::GetLastError();
+    if (errorMessageID == 0) { return std::string(); }//No error message has been recorded
+    LPSTR messageBuffer = nullptr;
+
+    //Ask Win32 to give us the string version of that message ID.
+    //The parameters we pass in, tell Win32 to create the buffer that holds the message for us (because we don't yet know how long the message string will be).
+    size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+        NULL, errorMessageID, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&messageBuffer, 0, NULL);
+
+    //Copy the error message into a std::string.
+    std::string message(messageBuffer, size);
+
+    //Free the Win32's string's buffer.
+    LocalFree(messageBuffer);
+
+    return message;
+}
+
+static std::shared_ptr<glcontext_base> create_context_win(HDC hDC, HGLRC share)
+{
+    if (glwindow_version_major() > 2)
+        return std::make_shared<glcontext_extended>(hDC, glwindow_version_major(), glwindow_version_minor(), share);
+    return std::make_shared<glcontext_base>(hDC, share);
+}
+
+static void glwindow_open_impl(std::shared_ptr<glwindow> window)
+{
+    glwindow* main = nullptr;
+    {
+        glwindow::current_scope scope(nullptr);
+        main = glwindow_get();
+    }
+    if (!hWnd_ || !main->context())
+        throw std::runtime_error("Windows can only be opened once the main window is created.");
+    if (main->render_thread())
+        throw std::runtime_error("Further windows are not supported with the render thread.");
+
+    // the caller's context is current again after...
+    HGLRC current = wglGetCurrentContext();
+    HDC current_dc = wglGetCurrentDC();
+    const glo::gl& dispatch = glo::gl::current();
+
+    glwindow::current_scope scope(window.get());
+    glwindow_view_win view;
+    view.window_ = window;
+    view.hwnd_ = CreateWindowEx(WS_EX_OVERLAPPEDWINDOW | WS_EX_ACCEPTFILES, wcex_.lpszClassName, L"glwindow", WS_OVERLAPPEDWINDOW,
+        CW_USEDEFAULT, CW_USEDEFAULT, 320, 240, NULL, NULL, hInst_, window.get());
+    if (!view.hwnd_)
+        throw std::runtime_error(get_last_error_as_string());
+
+    window->context(create_context_win(GetDC(view.hwnd_), context_win(main)->handle()));
+    window->context()->swap_interval(glwindow::swap_interval());
+    HWND hwnd = view.hwnd_;
+    window->waker([hwnd]() { PostMessage(hwnd, WM_NULL, 0, 0); });
+    views_.push_back(view);
+
+    RECT rect;
+    GetWindowRect(view.hwnd_, &rect);
+    SetWindowPos(view.hwnd_, HWND_TOP, rect.left, rect.top, glwindow::width(), glwindow::height(), NULL);
+    SetWindowText(view.hwnd_, glwindow::title().c_str());
+    ShowWindow(view.hwnd_, SW_SHOW);
+
+    wglMakeCurrent(current_dc, current);
+    glo::gl::current(&dispatch);
+}
+
+static void init_win(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+{
+    CoInitialize(nullptr);
+
+    wcex_.cbSize = sizeof(WNDCLASSEX);
+    wcex_.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
+    wcex_.lpfnWndProc = WndProc;
+    wcex_.cbClsExtra = 0;
+    wcex_.cbWndExtra = 0;
+    wcex_.hInstance = hInst_;
+    wcex_.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wcex_.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+    wcex_.lpszMenuName = NULL;
+    wcex_.lpszClassName = L"glwindow";
+
+    if (!RegisterClassEx(&wcex_))
+        throw std::runtime_error("Unable to register Window class");
+
+    hWnd_ = CreateWindowEx(WS_EX_OVERLAPPEDWINDOW | WS_EX_ACCEPTFILES, wcex_.lpszClassName, L"glwindow", WS_OVERLAPPEDWINDOW,
+        CW_USEDEFAULT, CW_USEDEFAULT, 320, 240, NULL, NULL, hInst_, NULL);
+
+    if (!hWnd_)
+        throw std::runtime_error(get_last_error_as_string());
+
+    hInst_ = hInstance;
+    glwindow::startup_mark("window");
+
+    // create the gl context...
+    auto context = create_context_win(GetDC(hWnd_), NULL);
+
+    // trigger the instance to construct it (if GLWINDOW_CLASS)...
+    glwindow_get()->context(context);
+    context->swap_interval(glwindow_get()->swap_interval());
+
+    // glwindow::invalidate from another thread wakes the message loop...
+    glwindow_get()->waker([]() { PostMessage(hWnd_, WM_NULL, 0, 0); });
+    glwindow::startup_mark("context");
+
+    // call the custom init (defined after GLWINDOW macro)...
+    glwindow_init_impl();
+    glwindow::startup_mark("init");
+
+    // the frame pacer sleeps rather than the coarse WM_TIMER...
+    timeBeginPeriod(1);
+
+    // Resize the window to desired...
+    RECT rect;
+    GetWindowRect(hWnd_, &rect);
+    SetWindowPos(hWnd_, HWND_TOP, rect.left, rect.top, glwindow_get()->width(), glwindow_get()->height(), NULL);
+
+    // Set the name of the window...
+    SetWindowText(hWnd_, glwindow_get()->title().c_str());
+}
+
+static int run_win()
+{
+    MSG msg;
+
+    // draw on the render thread, this thread only pumps messages...
+    if (glwindow_get()->render_thread())
+    {
+        HDC hDC = GetDC(hWnd_);
+        glcontext_base* context = static_cast<glcontext_base*>(glwindow_get()->context());
+        wglMakeCurrent(NULL, NULL);
+        glwindow_get()->render_thread_start(
+            [=]() { context->make_current(hDC); },
+            [=]() { SwapBuffers(hDC); },
+            []() { wglMakeCurrent(NULL, NULL); },
+            []() { PostMessage(hWnd_, WM_CLOSE, 0, 0); });
+
+        while (GetMessage(&msg, NULL, 0, 0))
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        glwindow_get()->render_thread_stop();
+        glwindow_get()->render_thread_error();
+        return (int)msg.wParam;
+    }
+
+    glwindow::frame_pacer& pacer = glwindow_get()->pacer();
+    glwindow::frame_stats& stats = glwindow_get()->stats();
+    while (true)
+    {
+        // pump everything pending (painting within is timed as draw)...
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+            while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+            {
+                if (msg.message == WM_QUIT)
+                    return (int)msg.wParam;
+                TranslateMessage(&msg);
+                DispatchMessage(&msg);
+            }
+            glwindow_get()->deliver_frame();
+        }
+
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::idle);
+            glwindow_get()->update();
+        }
+        run_views_win();
+
+        // on demand, paint what was invalidated (and can be seen), otherwise sleep until a message...
+        if (glwindow_get()->redraw_on_demand())
+        {
+            bool due = !glwindow_get()->target_fps() || pacer.due();
+            bool waiting = false;
+            const std::size_t count = views_.size();
+            for (std::size_t v = 0; v < count && v < views_.size(); ++v)
+            {
+                glwindow_view_win view = views_[v];
+                view.window_->window_visible(visible_win(view.hwnd_));
+                if (view.window_->window_visible() && view.window_->redraw_pending())
+                {
+                    if (due)
+                    {
+                        InvalidateRect(view.hwnd_, NULL, FALSE);
+                        UpdateWindow(view.hwnd_);
+                    }
+                    else
+                        waiting = true;
+                }
+            }
+            glwindow_get()->window_visible(visible_win(hWnd_));
+            if (glwindow::visible() && glwindow_get()->redraw_pending())
+            {
+                if (due)
+                {
+                    InvalidateRect(hWnd_, NULL, FALSE);
+                    UpdateWindow(hWnd_);
+                    continue;
+                }
+                waiting = true;
+            }
+            if (!waiting)
+            {
+                WaitMessage();
+                continue;
+            }
+        }
+        // no target, redraw on WM_PAINT only...
+        else if (!glwindow_get()->target_fps() && !glwindow_get()->redraw_continuous())
+        {
+            WaitMessage();
+            continue;
+        }
+
+        // frame deadline (or every pass, the swap waiting for vblank)...
+        if (glwindow_get()->redraw_continuous() || pacer.due())
+        {
+            // the further windows follow the main window's pacing (painting may open more)...
+            const std::size_t count = views_.size();
+            for (std::size_t v = 0; v < count && v < views_.size(); ++v)
+            {
+                HWND view = views_[v].hwnd_;
+                InvalidateRect(view, NULL, FALSE);
+                UpdateWindow(view);
+            }
+            InvalidateRect(hWnd_, NULL, FALSE);
+            UpdateWindow(hWnd_);
+            continue;
+        }
+
+        // sleep until the next message or the bulk of the frame interval, then spin the rest...
+        DWORD sleep = static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(pacer.sleep_time()).count());
+        if (sleep)
+        {
+            auto wake = std::chrono::steady_clock::now() + std::chrono::milliseconds(sleep);
+            if (MsgWaitForMultipleObjects(0, NULL, FALSE, sleep, QS_ALLINPUT) == WAIT_TIMEOUT)
+                pacer.overslept(std::chrono::steady_clock::now() - wake);
+        }
+        else if (!GetQueueStatus(QS_ALLINPUT))
+            pacer.wait();
+    }
+}
+
+#define GLWINDOW_IMPL int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) \
+{\
+    try\
+    {\
+        glwindow::startup_mark("main");\
+        init_win(hInstance, hPrevInstance, lpCmdLine, nCmdShow);\
+        ShowWindow(hWnd_, nCmdShow);\
+        UpdateWindow(hWnd_);\
+        glwindow::startup_mark("shown");\
+        return run_win();\
+    }\
+    catch (const std::exception& e) { MessageBox(NULL, ansi_to_wide(e.what()).c_str(), L"GLwindow", MB_ICONERROR); }\
+    catch (...) { MessageBox(NULL, L"Unknown error", L"GLwindow", MB_ICONERROR); }\
+    return 0;\
+}
+
+#endif // GLWINDOW_WIN
+
+// X.org platform implementation (shared by the window and headless backends)...
+#ifdef GLO_X
+
+#include <cstdio>
+#include <unistd.h>
+
+// set from any thread (e.g. render thread callbacks)...
+static std::atomic<bool> quit_{ false };
+static std::atomic<int> quit_code_{ 0 };
+
+// written by glwindow::invalidate (and quit) to wake the event loop from another thread...
+static int wake_pipe_x_[2] = { -1, -1 };
+
+static void wake_x()
+{
+    char wake = 0;
+    if (wake_pipe_x_[1] < 0 || write(wake_pipe_x_[1], &wake, 1) < 0)
+        return;     // none (headless) or full, the loop is already due to wake
+}
+
+#define GLWINDOW_QUIT(value) quit_x(value);
+
+static void quit_x(int value)
+{
+    quit_code_ = value;
+    quit_ = true;
+    wake_x();
+}
+
+// X and the file system take utf-8...
+static std::string wide_to_utf8(const std::wstring& wstr)
+{
+    std::string str;
+    for (auto c = wstr.begin(); c != wstr.end(); ++c)
+    {
+        unsigned int cp = static_cast<unsigned int>(*c);
+        if (cp < 0x80)
+            str += static_cast<char>(cp);
+        else if (cp < 0x800)
+        {
+            str += static_cast<char>(0xC0 | (cp >> 6));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            str += static_cast<char>(0xE0 | (cp >> 12));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            str += static_cast<char>(0xF0 | (cp >> 18));
+            str += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return str;
+}
+
+#endif // GLO_X
+
+// X.org window implementation (headless builds need no X server or libX11)...
+#if defined(GLO_X) && !defined(GLO_USE_EGL)
+
+#include <X11/Xutil.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <sys/select.h>
+#include <fcntl.h>
+
+static Display* display_;
+static Window window_;
+static Colormap colormap_;
+static Atom wm_delete_window_;
+static GLXFBConfig fbconfig_;
+static bool x_error_ = false;
+
+constexpr int WHEEL_DELTA_X = 120;     // match the win32 scroll delta...
+
+static int x_error_handler(Display*, XErrorEvent*)
+{
+    x_error_ = true;
+    return 0;
+}
+
+// a GL context, versioned (major > 0) through GLX_ARB_create_context...
+static GLXContext create_glx_context(Display* dpy, int major_version, int minor_version, GLXContext share)
+{
+    if (!major_version)
+        return glXCreateNewContext(dpy, fbconfig_, GLX_RGBA_TYPE, share, True);
+
+    int attribs[] =
+    {
+        GLX_CONTEXT_MAJOR_VERSION_ARB, major_version,
+        GLX_CONTEXT_MINOR_VERSION_ARB, minor_version,
+        GLX_CONTEXT_FLAGS_ARB, 0,
+        None
+    };
+
+    // no need for a temporary context, glx resolves without one...
+    PFNGLXCREATECONTEXTATTRIBSARBPROC glwindow_context_extended_glXCreateContextAttribsARB = (PFNGLXCREATECONTEXTATTRIBSARBPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXCreateContextAttribsARB"));
+    if (!glwindow_context_extended_glXCreateContextAttribsARB)
+        throw std::runtime_error("glXCreateContextAttribsARB unavailable.");
+
+    // an unsupported version raises an X error rather than returning null...
+    x_error_ = false;
+    auto handler = XSetErrorHandler(x_error_handler);
+    GLXContext context = glwindow_context_extended_glXCreateContextAttribsARB(dpy, fbconfig_, share, True, attribs);
+    XSync(dpy, False);
+    XSetErrorHandler(handler);
+    if (!context || x_error_)
+        throw std::runtime_error("Unable to create GL " + std::to_string(major_version) + "." + std::to_string(minor_version) + " context.");
+    return context;
+}
+
+// A context for a worker thread, current on the window but never drawn to it...
+class glcontext_shared : public glwindow::glcontext
+{
+public:
+    glcontext_shared(Window window, int major_version, int minor_version, GLXContext share, const glo::gl& dispatch)
+        : hGLrc_(create_glx_context(display_, major_version, minor_version, share)), drawable_(window)
+    {
+        if (!hGLrc_)
+            throw std::runtime_error("Unable to create shared GL context.");
+
+        // same driver as the context shared, same entry points...
+        dispatch_ = dispatch;
+    }
+    ~glcontext_shared() { glXDestroyContext(display_, hGLrc_); }
+
+    void attach()
+    {
+        if (!glXMakeContextCurrent(display_, drawable_, drawable_, hGLrc_))
+            throw std::runtime_error("Unable to make current.");
+        glo::gl::current(&dispatch_);
+    }
+    void detach() { glo::gpu_profiler::release(&dispatch_); glo::gl::current(nullptr); glXMakeContextCurrent(display_, None, None, NULL); }
+
+private:
+    GLXContext hGLrc_;
+    Window drawable_;
+};
+
+// The contexts...
+class glcontext_base : public glwindow::glcontext
+{
+public:
+    glcontext_base(void* display, Window window, GLXContext share = NULL)
+        : drawable_(window)
+    {
+        Display* dpy = static_cast<Display*>(display);
+        if (!dpy)
+            throw std::runtime_error("No display.");
+
+        hGLrc_ = create_glx_context(dpy, 0, 0, share);
+        if (!hGLrc_)
+            throw std::runtime_error("Unable to create GL context.");
+        make_current(display);
+
+        // resolve the entry points once for this context...
+        dispatch_.load();
+    }
+
+    void free(void* display) { glo::gpu_profiler::release(&dispatch_); glo::gl::current(nullptr); glXMakeContextCurrent(static_cast<Display*>(display), None, None, NULL); glXDestroyContext(static_cast<Display*>(display), hGLrc_); }
+    void make_current(void* display)
+    {
+        if (!glXMakeContextCurrent(static_cast<Display*>(display), drawable_, drawable_, hGLrc_))
+            throw std::runtime_error("Unable to make current.");
+        glo::gl::current(&dispatch_);
+    }
+
+    GLXContext handle() const { return hGLrc_; }
+
+    std::shared_ptr<glwindow::glcontext> shared()
+    {
+        return std::make_shared<glcontext_shared>(drawable_, major_version_, minor_version_, hGLrc_, dispatch_);
+    }
+
+    bool swap_interval(int interval)
+    {
+        const char* extensions = glXQueryExtensionsString(display_, DefaultScreen(display_));
+        if (!extensions)
+            return false;
+
+        // adaptive needs GLX_EXT_swap_control_tear...
+        if (interval < 0 && !strstr(extensions, "GLX_EXT_swap_control_tear"))
+            interval = -interval;
+
+        if (strstr(extensions, "GLX_EXT_swap_control"))
+        {
+            PFNGLXSWAPINTERVALEXTPROC glwindow_context_glXSwapIntervalEXT = (PFNGLXSWAPINTERVALEXTPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalEXT"));
+            if (glwindow_context_glXSwapIntervalEXT)
+            {
+                glwindow_context_glXSwapIntervalEXT(display_, drawable_, interval);
+                return true;
+            }
+        }
+        if (strstr(extensions, "GLX_MESA_swap_control") && interval >= 0)
+        {
+            PFNGLXSWAPINTERVALMESAPROC glwindow_context_glXSwapIntervalMESA = (PFNGLXSWAPINTERVALMESAPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalMESA"));
+            if (glwindow_context_glXSwapIntervalMESA)
+                return glwindow_context_glXSwapIntervalMESA(static_cast<unsigned int>(interval)) == 0;
+        }
+        return false;
+    }
+
+protected:
+    glcontext_base(Window window, int major_version, int minor_version) : drawable_(window), major_version_(major_version), minor_version_(minor_version) {}
+
+    GLXContext hGLrc_ = NULL;
+    Window drawable_;
+    int major_version_ = 0;     // 0 when not versioned
+    int minor_version_ = 0;
+};
+
+class glcontext_extended : public glcontext_base
+{
+public:
+    glcontext_extended(void* display, Window window, int major_version, int minor_version, GLXContext share = NULL)
+        : glcontext_base(window, major_version, minor_version)
+    {
+        Display* dpy = static_cast<Display*>(display);
+        if (!dpy)
+            throw std::runtime_error("No display.");
+
+        hGLrc_ = create_glx_context(dpy, major_version, minor_version, share);
+        make_current(display);
+
+        dispatch_.load();
+    }
+};
+
+// Map X keysyms onto the win32 virtual key codes so key handlers are portable...
+static unsigned int keysym_to_key(KeySym sym)
+{
+    if (sym >= XK_a && sym <= XK_z)
+        return static_cast<unsigned int>('A' + (sym - XK_a));
+    if ((sym >= XK_A && sym <= XK_Z) || (sym >= XK_0 && sym <= XK_9))
+        return static_cast<unsigned int>(sym);
+    if (sym >= XK_F1 && sym <= XK_F24)
+        return static_cast<unsigned int>(0x70 + (sym - XK_F1));
+    if (sym >= XK_KP_0 && sym <= XK_KP_9)
+        return static_cast<unsigned int>(0x60 + (sym - XK_KP_0));
+
+    switch (sym)
+    {
+    case XK_BackSpace: return 0x08;
+    case XK_Tab: return 0x09;
+    case XK_Return: case XK_KP_Enter: return 0x0D;
+    case XK_Shift_L: case XK_Shift_R: return 0x10;
+    case XK_Control_L: case XK_Control_R: return 0x11;
+    case XK_Alt_L: case XK_Alt_R: return 0x12;
+    case XK_Pause: return 0x13;
+    case XK_Caps_Lock: return 0x14;
+    case XK_Escape: return 0x1B;
+    case XK_space: return 0x20;
+    case XK_Prior: return 0x21;
+    case XK_Next: return 0x22;
+    case XK_End: return 0x23;
+    case XK_Home: return 0x24;
+    case XK_Left: return 0x25;
+    case XK_Up: return 0x26;
+    case XK_Right: return 0x27;
+    case XK_Down: return 0x28;
+    case XK_Insert: return 0x2D;
+    case XK_Delete: return 0x2E;
+    }
+    return static_cast<unsigned int>(sym);
+}
+
+static glwindow::mouse_button x_button(unsigned int button)
+{
+    switch (button)
+    {
+    case Button1: return glwindow::mouse_button::left;
+    case Button2: return glwindow::mouse_button::middle;
+    case Button3: return glwindow::mouse_button::right;
+    }
+    return glwindow::mouse_button::none;
+}
+
+// Further windows (glwindow::open), drawn after the main window each frame...
+struct glwindow_view_x
+{
+    std::shared_ptr<glwindow> window_;
+    Window handle_;
+    Colormap colormap_;
+};
+static std::vector<glwindow_view_x> views_;
+
+static glcontext_base* context_x(glwindow* window)
+{
+    return static_cast<glcontext_base*>(window->context());
+}
+
+static glwindow_view_x* view_x(Window handle)
+{
+    for (auto& view : views_)
+        if (view.handle_ == handle)
+            return &view;
+    return nullptr;
+}
+
+// the main window's context is current other than while a further window is handled...
+static void main_current_x()
+{
+    glwindow::current_scope scope(nullptr);
+    context_x(glwindow_get())->make_current(display_);
+}
+
+// kill and destroy a further window, the main context is current again after...
+static void close_view_x(Window handle)
+{
+    glwindow_view_x* found = view_x(handle);
+    if (!found)
+        return;
+
+    // by copy, kill may open a window and add to views_...
+    glwindow_view_x view = *found;
+    {
+        glwindow::current_scope scope(view.window_.get());
+        context_x(view.window_.get())->make_current(display_);
+        view.window_->kill();
+        context_x(view.window_.get())->free(display_);
+    }
+    XDestroyWindow(display_, view.handle_);
+    XFreeColormap(display_, view.colormap_);
+    if ((found = view_x(handle)))
+        views_.erase(views_.begin() + (found - views_.data()));
+
+    main_current_x();
+}
+
+// deliver, update (and draw) the further windows, each with its own context current, on demand windows draw if due...
+static void run_views_x(bool draw, bool due)
+{
+    if (views_.empty())
+        return;
+
+    // by copy and index, a handler opening a window adds to views_...
+    const std::size_t count = views_.size();
+    for (std::size_t v = 0; v < count && v < views_.size(); ++v)
+    {
+        glwindow_view_x view = views_[v];
+        glwindow::current_scope scope(view.window_.get());
+        context_x(view.window_.get())->make_current(display_);
+        glwindow::frame_stats& stats = view.window_->stats();
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+            view.window_->deliver_frame();
+        }
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::idle);
+            view.window_->update();
+        }
+        bool view_draw = view.window_->window_on_demand() ? due && view.window_->window_visible() && view.window_->take_redraw() : draw;
+        if (view_draw)
+        {
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::draw);
+                view.window_->draw();
+            }
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::swap);
+                glXSwapBuffers(display_, view.handle_);
+            }
+            stats.frame();
+            glwindow_get()->latency().swapped();
+            glo::gpu_profiler::current().frame();
+        }
+    }
+
+    main_current_x();
+}
+
+// an on demand window (main or further) has a draw pending for the next frame deadline...
+static bool redraw_waiting_x()
+{
+    for (auto& view : views_)
+        if (view.window_->window_on_demand() && view.window_->window_visible() && view.window_->redraw_pending())
+            return true;
+    return glwindow::redraw_on_demand() && glwindow::visible() && glwindow_get()->redraw_pending();
+}
+
+// a window's events...
+static void event_window_x(const XEvent& event, bool& redraw, bool view)
+{
+    switch (event.type)
+    {
+    case ClientMessage:
+    {
+        if (static_cast<Atom>(event.xclient.data.l[0]) == wm_delete_window_ && view)
+            close_view_x(event.xany.window);
+        else if (static_cast<Atom>(event.xclient.data.l[0]) == wm_delete_window_)
+            quit_x(0);
+        break;
+    }
+    case Expose:
+    {
+        if (event.xexpose.count == 0 && (glwindow_get()->render_thread() || glwindow::redraw_on_demand()))
+            glwindow_get()->post_redraw();
+        else if (event.xexpose.count == 0)
+            redraw = true;
+        break;
+    }
+    case MapNotify:
+    {
+        glwindow_get()->window_visible(true);
+        break;
+    }
+    case UnmapNotify:
+    {
+        // minimized (iconified windows are unmapped)...
+        glwindow_get()->window_visible(false);
+        break;
+    }
+    case VisibilityNotify:
+    {
+        // composited desktops report every mapped window as unobscured...
+        glwindow_get()->window_visible(event.xvisibility.state != VisibilityFullyObscured);
+        break;
+    }
+    case ConfigureNotify:
+    {
+        // also sent on move, only report size changes...
+        if (event.xconfigure.width != glwindow_get()->width() || event.xconfigure.height != glwindow_get()->height())
+        {
+            glwindow_get()->post(glwindow::event(glwindow::event::event_type::resize, event.xconfigure.width, event.xconfigure.height));
+        }
+        break;
+    }
+    case MotionNotify:
+    {
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_move, event.xmotion.x, event.xmotion.y));
+        break;
+    }
+    case ButtonPress:
+    {
+        if (event.xbutton.button == Button4 || event.xbutton.button == Button5)
+        {
+            glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_scroll, event.xbutton.x, event.xbutton.y, event.xbutton.button == Button4 ? WHEEL_DELTA_X : -WHEEL_DELTA_X));
+            break;
+        }
+        glwindow::mouse_button button = x_button(event.xbutton.button);
+        if (button == glwindow::mouse_button::none)
+            break;
+        glwindow_get()->click_begin(button);
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_down, event.xbutton.x, glwindow_get()->height() - event.xbutton.y, button));
+        break;
+    }
+    case ButtonRelease:
+    {
+        glwindow::mouse_button button = x_button(event.xbutton.button);
+        if (button == glwindow::mouse_button::none)
+            break;
+        int x = event.xbutton.x;
+        int y = event.xbutton.y;
+        if (glwindow_get()->is_click(button))
+            glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_click, x, glwindow_get()->height() - y, button));
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::mouse_up, x, glwindow_get()->height() - y, button));
+        break;
+    }
+    case KeyPress:
+    {
+        XKeyEvent key = event.xkey;
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::key_down, key.x, glwindow_get()->height() - key.y, static_cast<int>(keysym_to_key(XLookupKeysym(&key, 0)))));
+        break;
+    }
+    case KeyRelease:
+    {
+        XKeyEvent key = event.xkey;
+        glwindow_get()->post(glwindow::event(glwindow::event::event_type::key_up, key.x, glwindow_get()->height() - key.y, static_cast<int>(keysym_to_key(XLookupKeysym(&key, 0)))));
+        break;
     }
-    default:
-        return DefWindowProc(hWnd, message, wParam, lParam);
     }
-    return 0;
 }
 
-static std::wstring ansi_to_wide(const std::string& str)
+// X main callback, routes to the window the event is for...
+static void event_x(const XEvent& event, bool& redraw)
 {
-    int count = MultiByteToWideChar(CP_ACP, 0, str.c_str(), static_cast<int>(str.length()), NULL, 0);
-    std::wstring wstr(count, 0);
-    MultiByteToWideChar(CP_ACP, 0, str.c_str(), static_cast<int>(str.length()), &wstr[0], count);
-    return wstr;
+    // statics resolve to that window, GL calls to its context...
+    glwindow_view_x* view = views_.empty() || event.xany.window == window_ ? nullptr : view_x(event.xany.window);
+    glwindow::current_scope scope(view ? view->window_.get() : nullptr);
+    if (view)
+        context_x(view->window_.get())->make_current(display_);
+
+    event_window_x(event, redraw, view != nullptr);
+
+    if (view)
+        main_current_x();
 }
 
-static std::string get_last_error_as_string()
+static Window create_window_x(Colormap& colormap)
 {
-    //Get the error message ID, if any.
-    DWORD errorMessageID = ::GetLastError();
-    if (errorMessageID == 0) { return std::string(); }//No error message has been recorded
-    LPSTR messageBuffer = nullptr;
+    XVisualInfo* visual = glXGetVisualFromFBConfig(display_, fbconfig_);
+    if (!visual)
+        throw std::runtime_error("Unable to get visual.");
+
+    Window root = RootWindow(display_, visual->screen);
+    colormap = XCreateColormap(display_, root, visual->visual, AllocNone);
+
+    XSetWindowAttributes swa;
+    swa.colormap = colormap;
+    swa.border_pixel = 0;
+    swa.event_mask = ExposureMask | StructureNotifyMask | VisibilityChangeMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
+
+    Window window = XCreateWindow(display_, root, 0, 0, 320, 240, 0, visual->depth, InputOutput, visual->visual, CWBorderPixel | CWColormap | CWEventMask, &swa);
+    XFree(visual);
+    if (!window)
+        throw std::runtime_error("Unable to create window.");
+
+    // get told when the window is closed rather than killed...
+    XSetWMProtocols(display_, window, &wm_delete_window_, 1);
+    return window;
+}
 
-    //Ask Win32 to give us the string version of that message ID.
-    //The parameters we pass in, tell Win32 to create the buffer that holds the message for us (because we don't yet know how long the message string will be).
-    size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-        NULL, errorMessageID, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&messageBuffer, 0, NULL);
+static std::shared_ptr<glwindow::glcontext> create_context_x(Window window, GLXContext share)
+{
+    if (glwindow_version_major() > 2)
+        return std::make_shared<glcontext_extended>(display_, window, glwindow_version_major(), glwindow_version_minor(), share);
+    return std::make_shared<glcontext_base>(display_, window, share);
+}
 
-    //Copy the error message into a std::string.
-    std::string message(messageBuffer, size);
+// when a window's swaps reached the display (GLX_OML_sync_control), UST being CLOCK_MONOTONIC microseconds as steady_clock...
+static void present_query_x(glwindow* window, Window drawable)
+{
+    const char* extensions = glXQueryExtensionsString(display_, DefaultScreen(display_));
+    if (!extensions || !strstr(extensions, "GLX_OML_sync_control"))
+        return;
+    PFNGLXGETSYNCVALUESOMLPROC get_sync_values = (PFNGLXGETSYNCVALUESOMLPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXGetSyncValuesOML"));
+    if (!get_sync_values)
+        return;
+
+    window->latency().present_query([get_sync_values, drawable](std::uint64_t& swaps, std::chrono::steady_clock::time_point& when)
+        {
+            int64_t ust = 0, msc = 0, sbc = 0;
+            if (!get_sync_values(display_, drawable, &ust, &msc, &sbc) || ust <= 0 || sbc <= 0)
+                return false;
+            swaps = static_cast<std::uint64_t>(sbc);
+            when = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::microseconds(ust)));
+            return true;
+        });
+}
 
-    //Free the Win32's string's buffer.
-    LocalFree(messageBuffer);
+static void title_x(Window window, const glwindow_str& title)
+{
+    std::string utf8 = wide_to_utf8(title);
+    Xutf8SetWMProperties(display_, window, utf8.c_str(), utf8.c_str(), NULL, 0, NULL, NULL, NULL);
+}
 
-    return message;
+static void glwindow_open_impl(std::shared_ptr<glwindow> window)
+{
+    glwindow* main = nullptr;
+    {
+        glwindow::current_scope scope(nullptr);
+        main = glwindow_get();
+    }
+    if (!display_ || !main->context())
+        throw std::runtime_error("Windows can only be opened once the main window is created.");
+    if (main->render_thread())
+        throw std::runtime_error("Further windows are not supported with the render thread.");
+
+    // the caller's context is current again after...
+    GLXContext current = glXGetCurrentContext();
+    GLXDrawable drawable = glXGetCurrentDrawable();
+    const glo::gl& dispatch = glo::gl::current();
+
+    glwindow::current_scope scope(window.get());
+    glwindow_view_x view;
+    view.window_ = window;
+    view.handle_ = create_window_x(view.colormap_);
+    window->context(create_context_x(view.handle_, context_x(main)->handle()));
+    window->context()->swap_interval(glwindow::swap_interval());
+    window->waker(wake_x);
+    present_query_x(window.get(), view.handle_);
+    views_.push_back(view);
+
+    glXMakeContextCurrent(display_, drawable, drawable, current);
+    glo::gl::current(&dispatch);
+
+    // resize callback comes from the ConfigureNotify...
+    XResizeWindow(display_, view.handle_, glwindow::width(), glwindow::height());
+    title_x(view.handle_, glwindow::title());
+    XMapWindow(display_, view.handle_);
 }
 
-static void init_win(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
+static void init_x()
 {
-    CoInitialize(nullptr);
+    // the render thread swaps while this thread pumps events...
+    XInitThreads();
 
-    wcex_.cbSize = sizeof(WNDCLASSEX);
-    wcex_.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
-    wcex_.lpfnWndProc = WndProc;
-    wcex_.cbClsExtra = 0;
-    wcex_.cbWndExtra = 0;
-    wcex_.hInstance = hInst_;
-    wcex_.hCursor = LoadCursor(NULL, IDC_ARROW);
-    wcex_.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-    wcex_.lpszMenuName = NULL;
-    wcex_.lpszClassName = L"glwindow";
+    display_ = XOpenDisplay(NULL);
+    if (!display_)
+        throw std::runtime_error("Unable to open X display.");
+    glwindow::startup_mark("display");
 
-    if (!RegisterClassEx(&wcex_))
-        throw std::runtime_error("Unable to register Window class");
+    // choose a frame buffer config...
+    int fb_attribs[] =
+    {
+        GLX_X_RENDERABLE, True,
+        GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT,
+        GLX_RENDER_TYPE, GLX_RGBA_BIT,
+        GLX_X_VISUAL_TYPE, GLX_TRUE_COLOR,
+        GLX_RED_SIZE, 8,
+        GLX_GREEN_SIZE, 8,
+        GLX_BLUE_SIZE, 8,
+        GLX_ALPHA_SIZE, 8,
+        GLX_DEPTH_SIZE, 24,
+        GLX_STENCIL_SIZE, 8,
+        GLX_DOUBLEBUFFER, True,
+        None
+    };
 
-    hWnd_ = CreateWindowEx(WS_EX_OVERLAPPEDWINDOW | WS_EX_ACCEPTFILES, wcex_.lpszClassName, L"glwindow", WS_OVERLAPPEDWINDOW,
-        CW_USEDEFAULT, CW_USEDEFAULT, 320, 240, NULL, NULL, hInst_, NULL);
+    int count = 0;
+    GLXFBConfig* configs = glXChooseFBConfig(display_, DefaultScreen(display_), fb_attribs, &count);
+    if (!configs || !count)
+        throw std::runtime_error("Unable to choose frame buffer config.");
+    fbconfig_ = configs[0];
+    XFree(configs);
 
-    if (!hWnd_)
-        throw std::runtime_error(get_last_error_as_string());
+    wm_delete_window_ = XInternAtom(display_, "WM_DELETE_WINDOW", False);
+    window_ = create_window_x(colormap_);
 
-    hInst_ = hInstance;
+    // glwindow::invalidate from another thread wakes the event loop...
+    if (pipe(wake_pipe_x_) != 0)
+        throw std::runtime_error("Unable to create wake pipe.");
+    fcntl(wake_pipe_x_[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake_pipe_x_[1], F_SETFL, O_NONBLOCK);
+
+    // held keys repeat key_down only, as on win32...
+    XkbSetDetectableAutoRepeat(display_, True, NULL);
+    glwindow::startup_mark("window");
 
     // create the gl context...
-    auto context = glwindow_version_major() > 1 ?
-        std::make_shared<glcontext_base>(GetDC(hWnd_)) :
-        std::make_shared<glcontext_extended>(GetDC(hWnd_), glwindow_version_major(), glwindow_version_minor());
+    std::shared_ptr<glwindow::glcontext> context = create_context_x(window_, NULL);
 
     // trigger the instance to construct it (if GLWINDOW_CLASS)...
     glwindow_get()->context(context);
+    context->swap_interval(glwindow_get()->swap_interval());
+    glwindow_get()->waker(wake_x);
+    present_query_x(glwindow_get(), window_);
+    glwindow::startup_mark("context");
 
     // call the custom init (defined after GLWINDOW macro)...
     glwindow_init_impl();
+    glwindow::startup_mark("init");
 
-    // set the callback frame timer...
-    if (glwindow_get()->target_fps())
-        SetTimer(hWnd_, IDT_FRAME_TIMER, (1000 / glwindow_get()->target_fps()), NULL);
-
-    // Resize the window to desired...
-    RECT rect;
-    GetWindowRect(hWnd_, &rect);
-    SetWindowPos(hWnd_, HWND_TOP, rect.left, rect.top, glwindow_get()->width(), glwindow_get()->height(), NULL);
+    // Resize the window to desired (resize callback comes from the ConfigureNotify)...
+    XResizeWindow(display_, window_, glwindow_get()->width(), glwindow_get()->height());
 
     // Set the name of the window...
-    SetWindowText(hWnd_, glwindow_get()->title().c_str());
+    title_x(window_, glwindow_get()->title());
 }
 
-#define GLWINDOW_IMPL int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) \
+static int run_x()
+{
+    XMapWindow(display_, window_);
+    glwindow::startup_mark("mapped");
+
+    // draw on the render thread, this thread only pumps events...
+    if (glwindow_get()->render_thread())
+    {
+        glcontext_base* context = static_cast<glcontext_base*>(glwindow_get()->context());
+        glXMakeContextCurrent(display_, None, None, NULL);
+        glwindow_get()->render_thread_start(
+            [=]() { context->make_current(display_); },
+            []() { glXSwapBuffers(display_, window_); },
+            []() { glXMakeContextCurrent(display_, None, None, NULL); },
+            []()
+            {
+                // wake the event pump with a close...
+                XEvent close;
+                memset(&close, 0, sizeof(close));
+                close.xclient.type = ClientMessage;
+                close.xclient.window = window_;
+                close.xclient.format = 32;
+                close.xclient.data.l[0] = static_cast<long>(wm_delete_window_);
+                XSendEvent(display_, window_, False, NoEventMask, &close);
+                XFlush(display_);
+            });
+    }
+
+    glwindow::frame_pacer& pacer = glwindow_get()->pacer();
+    glwindow::frame_stats& stats = glwindow_get()->stats();
+    bool redraw = true;
+    while (!quit_)
+    {
+        // pump everything pending...
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+            while (!quit_ && XPending(display_))
+            {
+                XEvent event;
+                XNextEvent(display_, &event);
+                event_x(event, redraw);
+            }
+        }
+        if (quit_)
+            break;
+
+        // block for the next event (or a quit from the render thread), everything else happens on the render thread...
+        if (glwindow_get()->render_thread())
+        {
+            int fd = ConnectionNumber(display_);
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(fd, &fds);
+            FD_SET(wake_pipe_x_[0], &fds);
+            if (!quit_ && !XPending(display_) && select((fd > wake_pipe_x_[0] ? fd : wake_pipe_x_[0]) + 1, &fds, NULL, NULL, NULL) > 0 && FD_ISSET(wake_pipe_x_[0], &fds))
+            {
+                char drain[64];
+                while (read(wake_pipe_x_[0], drain, sizeof(drain)) > 0)
+                    ;
+            }
+            continue;
+        }
+
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+            glwindow_get()->deliver_frame();
+        }
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::idle);
+            glwindow_get()->update();
+        }
+
+        // on demand, only what was invalidated (or exposed) and can be seen...
+        bool due = !glwindow_get()->target_fps() || pacer.due();
+        if (glwindow::redraw_on_demand())
+            redraw = due && glwindow::visible() && glwindow_get()->take_redraw();
+        // frame deadline (or every pass, the swap waiting for vblank)...
+        else if ((glwindow_get()->target_fps() && pacer.due()) || glwindow_get()->redraw_continuous())
+            redraw = true;
+
+        // the further windows follow the main window's pacing...
+        run_views_x(redraw, due);
+
+        if (redraw)
+        {
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::draw);
+                glwindow_get()->draw();
+            }
+            {
+                glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::swap);
+                glXSwapBuffers(display_, window_);
+            }
+            pacer.frame();
+            stats.frame();
+            glwindow_get()->latency().swapped();
+            glo::gpu_profiler::current().frame();
+            redraw = false;
+        }
+
+        // sleep until the next event (or invalidate) or the bulk of the frame interval, then spin the rest,
+        // on demand there's no interval to wait for unless a draw is pending...
+        if (!quit_ && !glwindow_get()->redraw_continuous() && !XPending(display_))
+        {
+            bool paced = glwindow_get()->target_fps() && (!glwindow::redraw_on_demand() || redraw_waiting_x());
+            int fd = ConnectionNumber(display_);
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(fd, &fds);
+            FD_SET(wake_pipe_x_[0], &fds);
+            timeval tv;
+            timeval* timeout = NULL;
+            auto sleep = std::chrono::duration_cast<std::chrono::microseconds>(pacer.sleep_time());
+            if (paced)
+            {
+                tv.tv_sec = static_cast<time_t>(sleep.count() / 1000000);
+                tv.tv_usec = static_cast<suseconds_t>(sleep.count() % 1000000);
+                timeout = &tv;
+            }
+            auto wake = std::chrono::steady_clock::now() + sleep;
+            int ready = select((fd > wake_pipe_x_[0] ? fd : wake_pipe_x_[0]) + 1, &fds, NULL, NULL, timeout);
+            if (ready == 0 && paced)
+            {
+                if (sleep.count())
+                    pacer.overslept(std::chrono::steady_clock::now() - wake);
+                pacer.wait();
+            }
+            else if (ready > 0 && FD_ISSET(wake_pipe_x_[0], &fds))
+            {
+                char drain[64];
+                while (read(wake_pipe_x_[0], drain, sizeof(drain)) > 0)
+                    ;
+            }
+        }
+    }
+
+    while (!views_.empty())
+        close_view_x(views_.back().handle_);
+
+    if (glwindow_get()->render_thread())
+        glwindow_get()->render_thread_stop();
+    else
+        glwindow_get()->kill();
+
+    if (auto context = dynamic_cast<glcontext_base*>(glwindow_get()->context()))
+        context->free(display_);
+    XDestroyWindow(display_, window_);
+    XFreeColormap(display_, colormap_);
+    XCloseDisplay(display_);
+    close(wake_pipe_x_[0]);
+    close(wake_pipe_x_[1]);
+
+    glwindow_get()->render_thread_error();
+    return quit_code_;
+}
+
+#define GLWINDOW_IMPL int main() \
 {\
     try\
     {\
-        init_win(hInstance, hPrevInstance, lpCmdLine, nCmdShow);\
-        MSG msg;\
-        ShowWindow(hWnd_, nCmdShow);\
-        UpdateWindow(hWnd_);\
-        while (GetMessage(&msg, NULL, 0, 0))\
-        {\
-            glwindow_get()->idle();\
-            TranslateMessage(&msg);\
-            DispatchMessage(&msg);\
-        }\
-        return (int)msg.wParam;\
+        glwindow::startup_mark("main");\
+        init_x();\
+        return run_x();\
     }\
-    catch (const std::exception& e) { MessageBox(NULL, ansi_to_wide(e.what()).c_str(), L"GLwindow", MB_ICONERROR); }\
-    catch (...) { MessageBox(NULL, L"Unknown error", L"GLwindow", MB_ICONERROR); }\
-    return 0;\
+    catch (const std::exception& e) { std::fprintf(stderr, "GLwindow: %s\n", e.what()); }\
+    catch (...) { std::fprintf(stderr, "GLwindow: Unknown error\n"); }\
+    return 1;\
 }
 
-#endif // GLWINDOW_WIN
+#endif // GLWINDOW_X
+
+// Headless (EGL) implementation, draws into a frame buffer rather than a window...
+#if defined(GLO_X) && defined(GLO_USE_EGL)
+
+#include "glofb.hpp"
+
+static EGLDisplay egl_display_ = EGL_NO_DISPLAY;
+static EGLContext egl_context_ = EGL_NO_CONTEXT;
+static EGLSurface egl_surface_ = EGL_NO_SURFACE;
+static std::unique_ptr<glo::frame_buffer> headless_frame_;
+
+// Shared (worker) contexts outlive the headless one when their owner does, the display is only
+// terminated once the last of them is destroyed...
+static std::mutex egl_display_mutex_;
+static int egl_shared_contexts_ = 0;
+static bool egl_terminate_pending_ = false;
+
+// On demand the loop sleeps until glwindow::invalidate (from any thread) wakes it...
+static std::mutex headless_wake_mutex_;
+static std::condition_variable headless_wake_;
+static bool headless_woken_ = false;
+
+static void wake_headless()
+{
+    {
+        std::lock_guard<std::mutex> lock(headless_wake_mutex_);
+        headless_woken_ = true;
+    }
+    headless_wake_.notify_one();
+}
+
+static void wait_headless()
+{
+    std::unique_lock<std::mutex> lock(headless_wake_mutex_);
+
+    // a replay's events are due on a clock rather than a wake, so poll for them...
+    if (glwindow::replaying())
+        headless_wake_.wait_for(lock, std::chrono::milliseconds(1), []() { return headless_woken_; });
+    else
+        headless_wake_.wait(lock, []() { return headless_woken_; });
+    headless_woken_ = false;
+}
+
+// The frame buffer headless draws go to (bound during draw)...
+static glo::frame_buffer& glwindow_headless_frame()
+{
+    if (!headless_frame_)
+        throw std::runtime_error("No headless frame buffer.");
+    return *headless_frame_;
+}
+
+static void glwindow_open_impl(std::shared_ptr<glwindow>)
+{
+    throw std::runtime_error("Further windows are not supported headless.");
+}
+
+// A context for a worker thread, sharing the headless one...
+class glcontext_shared : public glwindow::glcontext
+{
+public:
+    glcontext_shared(EGLConfig config, int major_version, int minor_version, const glo::gl& dispatch)
+    {
+        EGLint context_attribs[] =
+        {
+            EGL_CONTEXT_MAJOR_VERSION, major_version,
+            EGL_CONTEXT_MINOR_VERSION, minor_version,
+            EGL_NONE
+        };
+        context_ = eglCreateContext(egl_display_, config, egl_context_, major_version > 2 ? context_attribs : NULL);
+        if (context_ == EGL_NO_CONTEXT)
+            throw std::runtime_error("Unable to create shared GL context.");
+
+        // a pbuffer can only be current on one thread, so one of its own...
+        if (egl_surface_ != EGL_NO_SURFACE)
+        {
+            EGLint pbuffer_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+            surface_ = eglCreatePbufferSurface(egl_display_, config, pbuffer_attribs);
+            if (surface_ == EGL_NO_SURFACE)
+                throw std::runtime_error("Unable to create pbuffer surface.");
+        }
+
+        // same driver as the context shared, same entry points...
+        dispatch_ = dispatch;
+
+        std::lock_guard<std::mutex> lock(egl_display_mutex_);
+        ++egl_shared_contexts_;
+    }
+    ~glcontext_shared()
+    {
+        std::lock_guard<std::mutex> lock(egl_display_mutex_);
+        if (surface_ != EGL_NO_SURFACE)
+            eglDestroySurface(egl_display_, surface_);
+        eglDestroyContext(egl_display_, context_);
+        if (--egl_shared_contexts_ == 0 && egl_terminate_pending_)
+        {
+            eglTerminate(egl_display_);
+            egl_terminate_pending_ = false;
+        }
+    }
+
+    void attach()
+    {
+        // the bound API is per thread...
+        eglBindAPI(EGL_OPENGL_API);
+        if (!eglMakeCurrent(egl_display_, surface_, surface_, context_))
+            throw std::runtime_error("Unable to make current.");
+        glo::gl::current(&dispatch_);
+    }
+    void detach() { glo::gpu_profiler::release(&dispatch_); glo::gl::current(nullptr); eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); }
+
+private:
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLSurface surface_ = EGL_NO_SURFACE;
+};
+
+class glcontext_headless : public glwindow::glcontext
+{
+public:
+    glcontext_headless(int width, int height, int major_version, int minor_version)
+        : major_version_(major_version), minor_version_(minor_version)
+    {
+        // prefer the surfaceless platform (no display server), otherwise the default display...
+        PFNEGLGETPLATFORMDISPLAYEXTPROC glwindow_context_headless_eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (glwindow_context_headless_eglGetPlatformDisplayEXT)
+            egl_display_ = glwindow_context_headless_eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (egl_display_ == EGL_NO_DISPLAY)
+            egl_display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (egl_display_ == EGL_NO_DISPLAY || !eglInitialize(egl_display_, NULL, NULL))
+            throw std::runtime_error("Unable to initialise EGL display.");
+
+        if (!eglBindAPI(EGL_OPENGL_API))
+            throw std::runtime_error("Unable to bind OpenGL API.");
+
+        EGLint config_attribs[] =
+        {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+        EGLint count = 0;
+        if (!eglChooseConfig(egl_display_, config_attribs, &config_, 1, &count) || !count)
+            throw std::runtime_error("Unable to choose EGL config.");
+
+        // legacy versions take whatever compatibility context is offered...
+        EGLint context_attribs[] =
+        {
+            EGL_CONTEXT_MAJOR_VERSION, major_version,
+            EGL_CONTEXT_MINOR_VERSION, minor_version,
+            EGL_NONE
+        };
+        egl_context_ = eglCreateContext(egl_display_, config_, EGL_NO_CONTEXT, major_version > 2 ? context_attribs : NULL);
+        if (egl_context_ == EGL_NO_CONTEXT)
+            throw std::runtime_error("Unable to create GL " + std::to_string(major_version) + "." + std::to_string(minor_version) + " context.");
+
+        // surfaceless if supported, otherwise a pbuffer to make current against...
+        std::string extensions = eglQueryString(egl_display_, EGL_EXTENSIONS);
+        if (extensions.find("EGL_KHR_surfaceless_context") == std::string::npos)
+        {
+            EGLint pbuffer_attribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+            egl_surface_ = eglCreatePbufferSurface(egl_display_, config_, pbuffer_attribs);
+            if (egl_surface_ == EGL_NO_SURFACE)
+                throw std::runtime_error("Unable to create pbuffer surface.");
+        }
+        make_current(NULL);
+
+        // resolve the entry points once for this context...
+        dispatch_.load();
+    }
+
+    void free(void*)
+    {
+        glo::gpu_profiler::release(&dispatch_);
+        glo::gl::current(nullptr);
+        eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (egl_surface_ != EGL_NO_SURFACE)
+            eglDestroySurface(egl_display_, egl_surface_);
+        eglDestroyContext(egl_display_, egl_context_);
+
+        std::lock_guard<std::mutex> lock(egl_display_mutex_);
+        if (egl_shared_contexts_)
+            egl_terminate_pending_ = true;
+        else
+            eglTerminate(egl_display_);
+    }
+    void make_current(void*)
+    {
+        if (!eglMakeCurrent(egl_display_, egl_surface_, egl_surface_, egl_context_))
+            throw std::runtime_error("Unable to make current.");
+        glo::gl::current(&dispatch_);
+    }
+
+    std::shared_ptr<glwindow::glcontext> shared()
+    {
+        return std::make_shared<glcontext_shared>(config_, major_version_, minor_version_, dispatch_);
+    }
+
+private:
+    EGLConfig config_ = NULL;
+    int major_version_;
+    int minor_version_;
+};
+
+static void init_headless()
+{
+    // create the gl context...
+    auto context = std::make_shared<glcontext_headless>(glwindow_get()->width(), glwindow_get()->height(), glwindow_version_major(), glwindow_version_minor());
+
+    // trigger the instance to construct it (if GLWINDOW_HEADLESS_CLASS)...
+    glwindow_get()->context(context);
+    glwindow_get()->waker(wake_headless);
+    glwindow::startup_mark("context");
+
+    // call the custom init (defined after GLWINDOW_HEADLESS macro)...
+    glwindow_init_impl();
+    glwindow::startup_mark("init");
+
+    // the frame buffer stands in for the window...
+    headless_frame_ = std::make_unique<glo::frame_buffer>(glwindow_get()->width(), glwindow_get()->height());
+    headless_frame_->color_attachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_NEAREST, GL_CLAMP_TO_EDGE);
+    headless_frame_->depth_attachment(GL_DEPTH_COMPONENT24);
+    glwindow_get()->resize(glwindow_get()->width(), glwindow_get()->height());
+}
+
+static int run_headless()
+{
+    const glo::gl& gl_fn = glo::gl::current();
+
+    // no frame timer, run as fast as possible until GLWINDOW_QUIT...
+    glwindow::frame_stats& stats = glwindow_get()->stats();
+    while (!quit_)
+    {
+        // no input, but a replay (glwindow::replay) is delivered at frame start...
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::events);
+            glwindow_get()->deliver_frame();
+        }
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::idle);
+            glwindow_get()->update();
+        }
+        if (quit_)
+            break;
+
+        // always visible, on demand only invalidated frames are drawn...
+        if (glwindow::redraw_on_demand() && !glwindow_get()->take_redraw())
+        {
+            wait_headless();
+            continue;
+        }
+
+        {
+            glwindow::frame_stats::section section(stats, glwindow::frame_stats::phase::draw);
+            gl_fn.glBindFramebuffer(GL_FRAMEBUFFER, headless_frame_->fbo());
+            glwindow_get()->draw();
+            gl_fn.glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+        stats.frame();
+        glwindow_get()->latency().swapped();
+        glo::gpu_profiler::current().frame();
+    }
+    glFinish();
+
+    glwindow_get()->kill();
+
+    headless_frame_.reset();
+    if (auto context = dynamic_cast<glcontext_headless*>(glwindow_get()->context()))
+        context->free(NULL);
+    return quit_code_;
+}
+
+#define GLWINDOW_HEADLESS_IMPL int main() \
+{\
+    try\
+    {\
+        glwindow::startup_mark("main");\
+        init_headless();\
+        return run_headless();\
+    }\
+    catch (const std::exception& e) { std::fprintf(stderr, "GLwindow: %s\n", e.what()); }\
+    catch (...) { std::fprintf(stderr, "GLwindow: Unknown error\n"); }\
+    return 1;\
+}
+
+#endif // GLWINDOW_HEADLESS
 
 
 
@@ -41,9 +41,11 @@ GLWINDOW_DRAW
 
 GLWINDOW_IDLE
 {
-    // Check the frame limiter, only increment angle if frame time has passed...
-    if (glwindow_get()->frame_limiter())
-        angle += 0.2f;
+    // Advance by the achieved frame time (the window paces draw to target_fps, no need to poll frame_limiter)...
+    static auto last = std::chrono::steady_clock::now();
+    auto now = std::chrono::steady_clock::now();
+    angle += 24.0f * std::chrono::duration<float>(now - last).count();
+    last = now;
 }
 
 GLWINDOW_RESIZE(w, h)